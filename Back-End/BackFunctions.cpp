@@ -3,23 +3,107 @@
 #include "Common/Structs.h"
 #include "Common/Enums.h"
 #include "Common/LanguageFunctions.h"
-#include "Common/StackFunctions.h"
 #include "Common/ReadTree.h"
 #include "Common/CommonFunctions.h"
+#include "Common/Locations.h"
 #include "Back-End/TreeToAsm.h"
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
-LangErrors PrintAsm(Language *lang_info, const char *filename_out) {
+static LangErrors PrintSourceMap(const SourceMap *map, const LocationTable *locations, const char *filename_asm, const char *filename_map);
+static void SourceMapDtor(SourceMap *map);
+
+// With `filename_map`, every line there maps an asm line to the source line:col whose
+// code starts on it. Nodes without a location leave no entries. With `pool`, the program
+// is taken from it instead of the tree.
+LangErrors PrintAsm(Language *lang_info, const NodePool *pool, const char *filename_out, const char *filename_map) {
     assert(lang_info);
     assert(filename_out);
 
-    FILE_OPEN_AND_CHECK(asm_file, filename_out, "w", NULL, lang_info->arr, lang_info->root);
+    FILE_OPEN_AND_CHECK(asm_file, filename_out, "w", lang_info->arr, lang_info->root);
     int ram_base = 0;
     AsmInfo asm_info = {};
+    SourceMap map = {};
+    if (filename_map) {
+        asm_info.map = &map;
+    }
 
-    PrintProgram(asm_file, lang_info->root->root, lang_info->arr, &ram_base, &asm_info);
+    LangErrors err = kSuccess;
+    if (pool) {
+        err = PrintProgramPool(asm_file, pool, lang_info->arr, &ram_base, &asm_info);
+    } else {
+        PrintProgram(asm_file, lang_info->root->root, lang_info->arr, &ram_base, &asm_info);
+    }
     fclose(asm_file);
 
+    if (err == kSuccess && filename_map) {
+        err = PrintSourceMap(&map, &lang_info->root->locations, filename_out, filename_map);
+    }
+    SourceMapDtor(&map);
+
+    return err;
+}
+
+static LangErrors PrintSourceMap(const SourceMap *map, const LocationTable *locations, const char *filename_asm, const char *filename_map) {
+    assert(map);
+    assert(locations);
+    assert(filename_asm);
+    assert(filename_map);
+
+    FILE_OPEN_AND_CHECK(asm_file, filename_asm, "r", NULL, NULL);
+    FileInfo Info = {};
+    LangErrors err = DoBufRead(asm_file, filename_asm, &Info);
+    fclose(asm_file);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    FILE *map_file = fopen(filename_map, "w");
+    if (!map_file) {
+        perror("Error opening file");
+        DoBufFree(&Info);
+        return kErrorOpening;
+    }
+
+    size_t asm_line = 1;
+    size_t cursor = 0;
+    for (size_t i = 0; i < map->size; i++) {
+        size_t offset = (size_t)map->asm_offset[i];
+        if (offset > Info.filesize) {
+            break;
+        }
+
+        // Code starts after the newline FPRINTF_LABEL puts in front of labels.
+        while (offset < Info.filesize && Info.buf_ptr[offset] == '\n') {
+            offset++;
+        }
+        for (; cursor < offset; cursor++) {
+            asm_line += (Info.buf_ptr[cursor] == '\n');
+        }
+
+        size_t line = 0;
+        size_t col  = 0;
+        if (GetLocation(locations, map->loc[i], &line, &col)) {
+            fprintf(map_file, "%zu %zu:%zu\n", asm_line, line, col);
+        }
+    }
+
+    fclose(map_file);
+    DoBufFree(&Info);
+
     return kSuccess;
+}
+
+static void SourceMapDtor(SourceMap *map) {
+    assert(map);
+
+    free(map->asm_offset);
+    free(map->loc);
+
+    map->asm_offset = NULL;
+    map->loc        = NULL;
+    map->size       = 0;
+    map->capacity   = 0;
 }
\ No newline at end of file
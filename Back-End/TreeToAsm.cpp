@@ -8,7 +8,9 @@
 #include "Common/Enums.h"
 #include "Common/Structs.h"
 #include "Common/CommonFunctions.h"
-#include "Common/StackFunctions.h"
+#include "Common/TreeWalk.h"
+#include "Common/LanguageFunctions.h"
+#include "Common/NodePool.h"
 
 #define FPRINTF(fmt, ...)                                       \
     do {                                                        \
@@ -22,13 +24,6 @@
     } while(0)
 
 
-#define CASE_BINARY_OP(node, op_name, asm_op)                                       \
-    case kOperation##op_name:                                                       \
-        PrintExpr(file, node->left, arr, ram_base, param_count, asm_info, indent);  \
-        PrintExpr(file, node->right, arr, ram_base, param_count, asm_info, indent); \
-        FPRINTF(#asm_op "\n");                                                      \
-        break
-
 #define CASE_UNARY_OP(node, op_name, asm_op)                                        \
     case kOperation##op_name:                                                       \
         PrintExpr(file, node->left, arr, ram_base, param_count, asm_info, indent);  \
@@ -36,16 +31,21 @@
         break
 
 static void CleanPositions(VariableArr *arr);
+static void NoteLocation(FILE *file, LangNode_t *node, AsmInfo *asm_info);
 static const char *ChooseCompareMode(LangNode_t *node);
 
 static void PrintFunction(FILE *file, LangNode_t *func_node, VariableArr *arr, int *ram_base, AsmInfo *asm_info, int indent);
 static void PrintExpr(FILE *file, LangNode_t *expr, VariableArr *arr, int ram_base, int param_count, AsmInfo *asm_info, int indent);
+static void PrintExprNode(FILE *file, LangNode_t *expr, VariableArr *arr, int ram_base, int param_count, AsmInfo *asm_info, int indent);
 static void PrintExprOperationCase(FILE *file, LangNode_t *expr, VariableArr *arr, int ram_base, int param_count, AsmInfo *asm_info, int indent);
+static const char *ArithmeticMnemonic(const LangNode_t *node);
 static void FindVarPosPopMN(FILE *file, VariableArr *arr, LangNode_t *node, int param_count, AsmInfo *asm_info, int indent);
 static int  FindVarPos(VariableArr *arr, LangNode_t *node, AsmInfo *asm_info);
 static void PushParamsToStack(FILE *file, LangNode_t *args_node, VariableArr *arr, int ram_base, int param_count, AsmInfo *asm_info, int indent);
 static void PushParamsToRam(FILE *file, LangNode_t *args_node, VariableArr *arr, int ram_base, int param_count, AsmInfo *asm_info, int indent);
 static void PrintStatement(FILE *file, LangNode_t *stmt, VariableArr *arr, int ram_base, int param_count, AsmInfo *asm_info, int indent);
+static void PrintStatementSequence(FILE *file, LangNode_t *seq, VariableArr *arr, int ram_base, int param_count, AsmInfo *asm_info, int indent);
+static void PrintBlock(FILE *file, LangNode_t *block, VariableArr *arr, int ram_base, int param_count, AsmInfo *asm_info, int indent);
 static void PrintStatementOperationCase(FILE *file, LangNode_t *stmt, VariableArr *arr, int ram_base, int param_count, AsmInfo *asm_info, int indent); 
 
 static void PrintIfToAsm(FILE *file, LangNode_t *stmt, VariableArr *arr, int ram_base, int param_count, AsmInfo *asm_info, int indent);
@@ -66,18 +66,52 @@ void PrintProgram(FILE *file, LangNode_t *root, VariableArr *arr, int *ram_base,
     assert(asm_info);
     if (!root) return;
 
-    asm_info->counter = 0;
+    TreeWalk walk = {};
+    TreeWalkCtor(&walk, &root, 0);
 
-    if (IsThatOperation(root, kOperationFunction)) {
-        PrintFunction(file, root, arr, ram_base, asm_info, 1);
-    }
+    WalkStep step = {};
+    while (TreeWalkNext(&walk, &step)) {
+        if (step.event != kWalkEnter) {
+            continue;
+        }
 
-    if (root->left) {
-        PrintProgram(file, root->left, arr, ram_base, asm_info);
+        asm_info->counter = 0;
+        if (IsThatOperation(step.node, kOperationFunction)) {
+            PrintFunction(file, step.node, arr, ram_base, asm_info, 1);
+        }
     }
-    if (root->right) {
-        PrintProgram(file, root->right, arr, ram_base, asm_info);
+    TreeWalkDtor(&walk);
+}
+
+// Ids of a compact pool come in the order PrintProgram enters the nodes. A function is
+// made into LangNode_t nodes of its own for printing, the rest stays in the pool.
+LangErrors PrintProgramPool(FILE *file, const NodePool *pool, VariableArr *arr, int *ram_base, AsmInfo *asm_info) {
+    assert(file);
+    assert(pool);
+    assert(arr);
+    assert(ram_base);
+    assert(asm_info);
+
+    LangErrors err = kSuccess;
+    for (size_t id = 1; id < pool->size && err == kSuccess; id++) {
+        asm_info->counter = 0;
+        if (pool->kind[id] != kOperation || pool->value[id].operation != kOperationFunction) {
+            continue;
+        }
+
+        LangRoot func = {};
+        LangNode_t *func_node = NULL;
+        err = LangRootCtor(&func);
+        if (err == kSuccess) {
+            err = NodePoolToTree(pool, (uint32_t) id, &func, &func_node);
+        }
+        if (err == kSuccess) {
+            PrintFunction(file, func_node, arr, ram_base, asm_info, 1);
+        }
+        TreeDtor(&func);
     }
+
+    return err;
 }
 
 static void PrintFunction(FILE *file, LangNode_t *func_node, VariableArr *arr, int *ram_base, AsmInfo *asm_info, int indent) {
@@ -117,32 +151,19 @@ static void FindVarPosPopMN(FILE *file, VariableArr *arr, LangNode_t *node, int
     assert(node);
     assert(asm_info);
 
-    int var_idx = -1;
     LangNode_t *check_node = node;
-
-    for (size_t i = 0; i < arr->size; i++) {
-        if (IsThatOperation(node, kOperationGetAddr) || IsThatOperation(node, kOperationCallAddr)) {
-            check_node = node->left;
-        }
-
-        if (arr->var_array[check_node->value.pos].variable_name && arr->var_array[i].variable_name
-                && strcmp(arr->var_array[i].variable_name, arr->var_array[check_node->value.pos].variable_name) == 0) {
-
-            if (arr->var_array[i].pos_in_code == -1) {
-                var_idx = arr->var_array[i].pos_in_code = asm_info->counter++;
-            } else {
-                var_idx = arr->var_array[i].pos_in_code;
-            }
-            CountValueWithParamCount(file, (-1) * param_count + var_idx, "ADD", "RCX", indent);
-            FPRINTF("POPM [RCX]\n");
-            break;
-        }
+    if (IsThatOperation(node, kOperationGetAddr) || IsThatOperation(node, kOperationCallAddr)) {
+        check_node = node->left;
     }
 
+    int var_idx = FindVarPos(arr, check_node, asm_info);
     if (var_idx == -1) {
         fprintf(stderr, "Unknown variable\n");
         return; //
     }
+
+    CountValueWithParamCount(file, (-1) * param_count + var_idx, "ADD", "RCX", indent);
+    FPRINTF("POPM [RCX]\n");
 }
 
 static int FindVarPos(VariableArr *arr, LangNode_t *node, AsmInfo *asm_info) {
@@ -150,19 +171,18 @@ static int FindVarPos(VariableArr *arr, LangNode_t *node, AsmInfo *asm_info) {
     assert(node);
     assert(asm_info);
 
-    int var_idx = -1;
+    // Names are interned, so the node position is the only entry with this name.
+    if (node->value.pos >= arr->size || !arr->var_array[node->value.pos].variable_name) {
+        return -1;
+    }
 
-    for (size_t i = 0; i < arr->size; i++) {
-        if (strcmp(arr->var_array[i].variable_name, arr->var_array[node->value.pos].variable_name) == 0) {
-            if (arr->var_array[i].pos_in_code == -1) {
-                var_idx = arr->var_array[i].pos_in_code = asm_info->counter++;
-            } else {
-                var_idx = arr->var_array[i].pos_in_code;
-            }
-        }
+    VariableInfo *var = &arr->var_array[node->value.pos];
+
+    if (var->pos_in_code == -1) {
+        var->pos_in_code = asm_info->counter++;
     }
 
-    return var_idx;
+    return var->pos_in_code;
 }
 
 static void PushParamsToStack(FILE *file, LangNode_t *args_node, VariableArr *arr, int ram_base, int param_count, AsmInfo *asm_info, int indent) {
@@ -209,6 +229,8 @@ static void PrintStatement(FILE *file, LangNode_t *stmt, VariableArr *arr, int r
     assert(asm_info);
     if (!stmt) return;
 
+    NoteLocation(file, stmt, asm_info);
+
     switch (stmt->type) {
         case kOperation:
             PrintStatementOperationCase(file, stmt, arr, ram_base, param_count, asm_info, indent);
@@ -222,18 +244,114 @@ static void PrintStatement(FILE *file, LangNode_t *stmt, VariableArr *arr, int r
             FPRINTF("PUSH %.0f", stmt->value.number);
             break;
 
+        case kBlock:
+            PrintBlock(file, stmt, arr, ram_base, param_count, asm_info, indent);
+            break;
+
         default:
             fprintf(stderr, "No such switch case.\n");
             break;
     }
 }
 
+static void PrintBlock(FILE *file, LangNode_t *block, VariableArr *arr, int ram_base, int param_count, AsmInfo *asm_info, int indent) {
+    assert(file);
+    assert(block);
+    assert(arr);
+    assert(asm_info);
+
+    NodeList *list = block->value.block;
+    for (size_t i = 0; i < list->size; i++) {
+        PrintStatement(file, list->items[i], arr, ram_base, param_count, asm_info, indent);
+    }
+}
+
+// `~~` chains of older trees are as deep as they are long, so they are walked rather than recursed into.
+static void PrintStatementSequence(FILE *file, LangNode_t *seq, VariableArr *arr, int ram_base, int param_count, AsmInfo *asm_info, int indent) {
+    assert(file);
+    assert(seq);
+    assert(arr);
+    assert(asm_info);
+
+    TreeWalk walk = {};
+    TreeWalkCtor(&walk, &seq, 0);
+
+    WalkStep step = {};
+    while (TreeWalkNext(&walk, &step)) {
+        if (step.event != kWalkEnter) {
+            continue;
+        }
+
+        if (!IsThatOperation(step.node, kOperationThen)) {
+            PrintStatement(file, step.node, arr, ram_base, param_count, asm_info, indent);
+            TreeWalkSkip(&walk);
+        } else if (step.depth > 0) {
+            NoteLocation(file, step.node, asm_info);
+        }
+    }
+    TreeWalkDtor(&walk);
+}
+
+// Arithmetic is walked rather than recursed into, a long `augeo` chain is as deep as it is long.
+// Its operands are pushed in order and the operator comes on leaving.
 static void PrintExpr(FILE *file, LangNode_t *expr, VariableArr *arr, int ram_base, int param_count, AsmInfo *asm_info, int indent) {
     assert(file);
     assert(arr);
     assert(asm_info);
     if (!expr) return;
 
+    TreeWalk walk = {};
+    TreeWalkCtor(&walk, &expr, 0);
+
+    WalkStep step = {};
+    while (TreeWalkNext(&walk, &step)) {
+        bool sqrt_right = step.parent && IsThatOperation(step.parent, kOperationSQRT) && step.link == &step.parent->right;
+        const char *mnemonic = sqrt_right ? NULL : ArithmeticMnemonic(step.node);
+
+        if (step.event == kWalkEnter) {
+            if (sqrt_right) {
+                TreeWalkSkip(&walk);
+                continue;
+            }
+
+            NoteLocation(file, step.node, asm_info);
+            if (!mnemonic) {
+                PrintExprNode(file, step.node, arr, ram_base, param_count, asm_info, indent);
+                TreeWalkSkip(&walk);
+            }
+        } else if (step.event == kWalkLeave && mnemonic) {
+            FPRINTF("%s\n", mnemonic);
+        }
+    }
+    TreeWalkDtor(&walk);
+}
+
+static const char *ArithmeticMnemonic(const LangNode_t *node) {
+    assert(node);
+
+    if (node->type != kOperation) {
+        return NULL;
+    }
+
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wswitch-enum"
+    switch (node->value.operation) {
+        case kOperationAdd:  return "ADD";
+        case kOperationSub:  return "SUB";
+        case kOperationMul:  return "MUL";
+        case kOperationDiv:  return "DIV";
+        case kOperationSQRT: return "SQRT";
+        default:             return NULL;
+    }
+    #pragma GCC diagnostic pop
+}
+
+static void PrintExprNode(FILE *file, LangNode_t *expr, VariableArr *arr, int ram_base, int param_count, AsmInfo *asm_info, int indent) {
+    assert(file);
+    assert(expr);
+    assert(arr);
+    assert(asm_info);
+
     switch (expr->type) {
         case kNumber:
             FPRINTF("PUSH %.0f", expr->value.number);
@@ -245,7 +363,44 @@ static void PrintExpr(FILE *file, LangNode_t *expr, VariableArr *arr, int ram_ba
         case kOperation:
             PrintExprOperationCase(file, expr, arr, ram_base, param_count, asm_info, indent);
             break;
+        case kBlock:
+            PrintBlock(file, expr, arr, ram_base, param_count, asm_info, indent);
+            break;
+    }
+}
+
+// Remembers where the code of a located node starts, the asm lines are counted later.
+static void NoteLocation(FILE *file, LangNode_t *node, AsmInfo *asm_info) {
+    assert(file);
+    assert(node);
+    assert(asm_info);
+
+    SourceMap *map = asm_info->map;
+    if (!map || node->loc == 0 || (map->size > 0 && map->loc[map->size - 1] == node->loc)) {
+        return;
+    }
+
+    if (map->size == map->capacity) {
+        size_t capacity = map->capacity ? map->capacity * 2 : 64;
+
+        long *new_offset = (long *) realloc (map->asm_offset, capacity * sizeof(long));
+        if (!new_offset) {
+            return;
+        }
+        map->asm_offset = new_offset;
+
+        uint32_t *new_loc = (uint32_t *) realloc (map->loc, capacity * sizeof(uint32_t));
+        if (!new_loc) {
+            return;
+        }
+        map->loc = new_loc;
+
+        map->capacity = capacity;
     }
+
+    map->asm_offset[map->size] = ftell(file);
+    map->loc[map->size] = node->loc;
+    map->size++;
 }
 
 static void CleanPositions(VariableArr *arr) {
@@ -470,8 +625,7 @@ static void PrintStatementOperationCase(FILE *file, LangNode_t *stmt, VariableAr
             break;
 
         case kOperationThen:
-            PrintStatement(file, stmt->left, arr, ram_base, param_count, asm_info, indent);
-            PrintStatement(file, stmt->right, arr, ram_base, param_count, asm_info, indent);
+            PrintStatementSequence(file, stmt, arr, ram_base, param_count, asm_info, indent);
             break;
 
         case kOperationIf: 
@@ -520,12 +674,6 @@ static void PrintExprOperationCase(FILE *file, LangNode_t *expr, VariableArr *ar
             PrintDereference(file, expr->left, arr, param_count, asm_info, indent);
             break;
 
-        CASE_UNARY_OP(expr, SQRT, SQRT);
-        CASE_BINARY_OP(expr, Add, ADD);
-        CASE_BINARY_OP(expr, Sub, SUB);
-        CASE_BINARY_OP(expr, Mul, MUL);
-        CASE_BINARY_OP(expr, Div, DIV);
-
         case kOperationCall:
             PushParamsToStack(file, expr->right, arr, ram_base, param_count, asm_info, indent);
             FPRINTF("CALL :%s\n", arr->var_array[expr->left->value.pos].variable_name);
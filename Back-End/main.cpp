@@ -2,29 +2,77 @@
 #include "Common/Enums.h"
 #include "Common/LanguageFunctions.h"
 #include "Common/DoGraph.h"
-#include "Common/StackFunctions.h"
 #include "Common/ReadTree.h"
 #include "Common/CommonFunctions.h"
 #include "Back-End/TreeToAsm.h"
 #include "Back-End/BackFunctions.h"
+#include "Common/NodeArena.h"
+#include "Common/NodePool.h"
 
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
 
 int main(int argc, char *argv[]) {
-    (void)argc;
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <ast> <asm> [--map[=file]] [--pool]\n", argv[0]);
+        return kFailure;
+    }
 
     const char *filename_in = argv[1];
     const char *filename_out= argv[2];
 
-    INIT_EVERYTHING(root, Variable_Array, lang_info, tokens_no, dump_info);
+    char *filename_map = NULL;
+    bool use_pool = false;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--map") == 0) {
+            free(filename_map);
+            filename_map = (char *) calloc (strlen(filename_out) + sizeof(".map"), sizeof(char));
+            if (!filename_map) {
+                return kNoMemory;
+            }
+            strcpy(filename_map, filename_out);
+            strcat(filename_map, ".map");
+        } else if (strncmp(argv[i], "--map=", strlen("--map=")) == 0) {
+            free(filename_map);
+            filename_map = strdup(argv[i] + strlen("--map="));
+            if (!filename_map) {
+                return kNoMemory;
+            }
+        } else if (strcmp(argv[i], "--pool") == 0) {
+            use_pool = true;
+        }
+    }
 
-    CHECK_ERROR_RETURN(ReadTreeAndParse(&lang_info, &dump_info, filename_in), NULL, NULL, NULL); //TODO: наоборот
+    INIT_EVERYTHING(root, Variable_Array, lang_info, dump_info);
+
+    CHECK_ERROR_RETURN(ReadTreeAndParse(&lang_info, &dump_info, filename_in), NULL, NULL); //TODO: наоборот
 
     DoTreeInGraphviz(lang_info.root->root, &dump_info, &Variable_Array);
 
-    CHECK_ERROR_RETURN(PrintAsm(&lang_info, filename_out), NULL, NULL, NULL);
+    NodePool pool = {};
+    if (use_pool) {
+        uint32_t pool_root = 0;
+
+        err = NodePoolCtor(&pool, root.size);
+        if (err == kSuccess) {
+            err = NodePoolFromTree(&pool, root.root, &pool_root);
+        }
+        NodeArenaDtor(&root.arena);
+        root.root = NULL;
+
+        if (err != kSuccess) {
+            NodePoolDtor(&pool);
+            free(filename_map);
+        }
+        CHECK_ERROR_RETURN(err, &Variable_Array, &root);
+    }
+
+    err = PrintAsm(&lang_info, use_pool ? &pool : NULL, filename_out, filename_map);
+    free(filename_map);
+    NodePoolDtor(&pool);
+    CHECK_ERROR_RETURN(err, NULL, NULL);
 
     TreeDtor(lang_info.root);
     DtorVariableArray(&Variable_Array);
@@ -4,10 +4,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include "Common/Enums.h"
 #include "Common/Structs.h"
-#include "Common/StackFunctions.h"
 #include "Common/LanguageFunctions.h"
 #include "Common/ReadTree.h"
 
@@ -29,65 +30,115 @@ bool IsThisNodeType(LangNode_t *node, NodeTypes type) {
     return false;
 }
 
-static long long SizeOfFile(const char *filename) {
-    assert(filename);
+static LangErrors MapToBuf(int fd, FileInfo *Info) {
+    assert(Info);
 
-    struct stat stbuf = {};
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (page_size <= 0) {
+        return kFailure;
+    }
 
-    int err = stat(filename, &stbuf);
-    if (err != kSuccess) {
-        perror("stat() failed");
-        return kErrorStat;
+    // One spare zero byte past EOF is the NUL sentinel: reserve an anonymous
+    // zero-filled region and map the file over its head.
+    size_t page = (size_t)page_size;
+    size_t map_size = (Info->filesize + 1 + page - 1) / page * page;
+
+    void *base = mmap(NULL, map_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        return kNoMemory;
+    }
+
+    if (Info->filesize > 0 &&
+            mmap(base, Info->filesize, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, map_size);
+        return kFailure;
     }
 
-    return stbuf.st_size;
+    Info->buf_ptr  = (char *)base;
+    Info->map_size = map_size;
+    return kSuccess;
 }
 
-static char *ReadToBuf(const char *filename, FILE *file, size_t filesize) {
-    assert(filename);
+static LangErrors ReadToBuf(FILE *file, FileInfo *Info) {
     assert(file);
+    assert(Info);
 
-    char *buf_in = (char *) calloc (filesize + 2, sizeof(char));
-    if (!buf_in) {
+    size_t capacity = Info->filesize + 1;
+    char *buf = (char *) calloc (capacity, sizeof(char));
+    if (!buf) {
         fprintf(stderr, "ERROR while calloc.\n");
-        return NULL;
-    }
-
-    size_t bytes_read = fread(buf_in, 1, filesize, file);
-
-    char *buf_out = (char *) calloc (bytes_read + 1, 1);
-    if (!buf_out) {
-        fprintf(stderr, "ERROR while calloc buf_out.\n");
-        free(buf_in);
-        return NULL;
+        return kNoMemory;
     }
 
-    size_t j = 0;
-    for (size_t i = 0; i < bytes_read; i++) {
-        buf_out[j++] = buf_in[i];
+    size_t size = 0;
+    while (true) {
+        size += fread(buf + size, 1, capacity - size - 1, file);
+        if (size + 1 < capacity || feof(file) || ferror(file)) {
+            break;
+        }
+
+        char *new_buf = (char *) realloc (buf, capacity * 2);
+        if (!new_buf) {
+            fprintf(stderr, "ERROR while realloc.\n");
+            free(buf);
+            return kNoMemory;
+        }
+        buf = new_buf;
+        capacity *= 2;
     }
 
-    buf_out[j] = '\0';
-    free(buf_in);
+    buf[size] = '\0';
 
-    return buf_out;
+    Info->buf_ptr  = buf;
+    Info->filesize = size;
+    Info->map_size = 0;
+    return kSuccess;
 }
 
-void DoBufRead(FILE *file, const char *filename, FileInfo *Info) {
+LangErrors DoBufRead(FILE *file, const char *filename, FileInfo *Info) {
     assert(file);
     assert(filename);
     assert(Info);
 
-    Info->filesize = (size_t)SizeOfFile(filename) * 4;
+    Info->buf_ptr  = NULL;
+    Info->filesize = 0;
+    Info->map_size = 0;
+
+    int fd = fileno(file);
+    struct stat stbuf = {};
+
+    if (fd >= 0 && fstat(fd, &stbuf) == 0 && S_ISREG(stbuf.st_mode)) {
+        Info->filesize = (size_t)stbuf.st_size;
+        if (MapToBuf(fd, Info) == kSuccess) {
+            return kSuccess;
+        }
+    }
+
+    LangErrors err = ReadToBuf(file, Info);
+    if (err != kSuccess) {
+        fprintf(stderr, "Error reading \"%s\".\n", filename);
+    }
+
+    return err;
+}
+
+void DoBufFree(FileInfo *Info) {
+    assert(Info);
+
+    if (Info->map_size) {
+        munmap(Info->buf_ptr, Info->map_size);
+    } else {
+        free(Info->buf_ptr);
+    }
 
-    Info->buf_ptr = ReadToBuf(filename, file, Info->filesize);
-    assert(Info->buf_ptr != NULL);
+    Info->buf_ptr  = NULL;
+    Info->filesize = 0;
+    Info->map_size = 0;
 }
 
-void CleanupOnFileError(void *arg1, void *arg2, void *arg3) {
-    if (arg1 != NULL) StackDtor((Stack_Info *)arg1, stderr);
-    if (arg2 != NULL) DtorVariableArray((VariableArr *)arg2);
-    if (arg3 != NULL) TreeDtor((LangRoot *)arg3);
+void CleanupOnFileError(VariableArr *arr, LangRoot *root) {
+    if (arr != NULL) DtorVariableArray(arr);
+    if (root != NULL) TreeDtor(root);
 }
 
 LangErrors ReadTreeAndParse(Language *lang_info, DumpInfo *dump_info, const char *filename_in) {
@@ -95,17 +146,24 @@ LangErrors ReadTreeAndParse(Language *lang_info, DumpInfo *dump_info, const char
     assert(dump_info);
     assert(filename_in);
 
-    FILE_OPEN_AND_CHECK(ast_file, filename_in, "r", NULL, lang_info->arr, lang_info->root);
+    FILE_OPEN_AND_CHECK(ast_file, filename_in, "r", lang_info->arr, lang_info->root);
     FileInfo info = {};
-    DoBufRead(ast_file, filename_in, &info);
+    LangErrors err = DoBufRead(ast_file, filename_in, &info);
     fclose(ast_file);
+    if (err != kSuccess) {
+        CleanupOnFileError(lang_info->arr, lang_info->root);
+        return err;
+    }
 
     size_t pos = 0;
     LangNode_t *tree = NULL;
 
-    LangErrors err = kSuccess;
-    CHECK_ERROR_RETURN(ParseNodeFromString(info.buf_ptr, &pos, NULL, &tree, lang_info->arr), NULL, lang_info->arr, lang_info->root);
-    free(info.buf_ptr);
+    err = ParseNodeFromString(info.buf_ptr, &pos, NULL, &tree, lang_info->arr, lang_info->root);
+    DoBufFree(&info);
+    if (err != kSuccess) {
+        CleanupOnFileError(lang_info->arr, lang_info->root);
+        return err;
+    }
 
     lang_info->root->root = tree;
     dump_info->tree = lang_info->root;
@@ -6,6 +6,7 @@
 
 #include "Common/Enums.h"
 #include "Common/Structs.h"
+#include "Common/TreeWalk.h"
 
 #define FILE_OUT "output.txt"
 #define MAX_COMMAND_SIZE 50
@@ -13,7 +14,7 @@
 
 static const char *GetNodeTypeString(NodeTypes type);
 static void GenerateGraphImage(DumpInfo *info);
-static void WriteDotNode(FILE *file, const LangNode_t *node, bool flag, VariableArr *arr);
+static void WriteDotTree(FILE *file, const LangNode_t *root, VariableArr *arr);
 static GraphOperation PrintExpressionType(const LangNode_t *node);
 
 static void WriteDotHeader(FILE *file);
@@ -24,6 +25,7 @@ static void WriteNodeConnection(FILE *file, const LangNode_t *from, const LangNo
 static void WriteNumberNode(FILE *file, const LangNode_t *node);
 static void WriteVariableNode(FILE *file, const LangNode_t *node, VariableArr *arr);
 static void WriteOperationNode(FILE *file, const LangNode_t *node);
+static void WriteBlockNode(FILE *file, const LangNode_t *node);
 static void WriteUnknownNode(FILE *file, const LangNode_t *node);
 
 void DoTreeInGraphviz(const LangNode_t *root, DumpInfo *info, VariableArr *arr) {
@@ -39,7 +41,7 @@ void DoTreeInGraphviz(const LangNode_t *root, DumpInfo *info, VariableArr *arr)
 
     WriteDotHeader(dot_file);
     WriteRootNode(dot_file, root);
-    WriteDotNode(dot_file, root, info->flag_new, arr);
+    WriteDotTree(dot_file, root, arr);
     fprintf(dot_file, "}\n");
     
     fclose(dot_file);
@@ -70,23 +72,30 @@ static void WriteRootNode(FILE *file, const LangNode_t *root) {
     }
 }
 
-static void WriteDotNode(FILE *file, const LangNode_t *node, bool flag, VariableArr *arr) {
+static void WriteDotTree(FILE *file, const LangNode_t *root, VariableArr *arr) {
     assert(file);
-    assert(node);
+    assert(root);
     assert(arr);
 
-    WriteNodeDefinition(file, node, arr);
-    
-    if (node->left) {
-        WriteNodeConnection(file, node, node->left);
-        WriteDotNode(file, node->left, flag, arr);
-    }
-    
-    if (node->right) {
-        WriteNodeConnection(file, node, node->right);
-        fprintf(file, "\n");
-        WriteDotNode(file, node->right, flag, arr);
+    LangNode_t *top = const_cast<LangNode_t *>(root);
+    TreeWalk walk = {};
+    TreeWalkCtor(&walk, &top, 0);
+
+    WalkStep step = {};
+    while (TreeWalkNext(&walk, &step)) {
+        if (step.event != kWalkEnter) {
+            continue;
+        }
+
+        if (step.parent) {
+            WriteNodeConnection(file, step.parent, step.node);
+            if (step.link == &step.parent->right) {
+                fprintf(file, "\n");
+            }
+        }
+        WriteNodeDefinition(file, step.node, arr);
     }
+    TreeWalkDtor(&walk);
 }
 
 static void WriteNodeDefinition(FILE *file, const LangNode_t *node, VariableArr *arr) {
@@ -104,6 +113,9 @@ static void WriteNodeDefinition(FILE *file, const LangNode_t *node, VariableArr
         case kOperation:
             WriteOperationNode(file, node);
             break;
+        case kBlock:
+            WriteBlockNode(file, node);
+            break;
         default:
             WriteUnknownNode(file, node);
             break;
@@ -157,6 +169,15 @@ static void WriteOperationNode(FILE *file, const LangNode_t *node) {
         PrintExpressionType(node).operation_name, (void *)node->left, (void *)node->right, PrintExpressionType(node).color);
 }
 
+static void WriteBlockNode(FILE *file, const LangNode_t *node) {
+    assert(file);
+    assert(node);
+
+    fprintf(file, DOT_INDENT "\"%p\" [label=\"{Parent: %p \\n | Addr: %p \\n | Type: %s", 
+        (const void *)node, (const void *)node->parent, (const void *)node, GetNodeTypeString(node->type));
+    fprintf(file, " | Items: %zu}\" shape=Mrecord color=black fillcolor=pink, style=filled];\n", node->value.block->size);
+}
+
 static void WriteUnknownNode(FILE *file, const LangNode_t *node) {
     assert(file);
     assert(node);
@@ -180,6 +201,7 @@ static const char *GetNodeTypeString(NodeTypes type) {
         case kNumber:    return "NUM";
         case kVariable:  return "VAR";
         case kOperation: return "OP";
+        case kBlock:     return "BLOCK";
         default:         return "UNKNOWN";
     }
 }
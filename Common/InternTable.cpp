@@ -0,0 +1,158 @@
+#include "Common/InternTable.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+// Open addressing with linear probing over a power-of-two table kept at most half full.
+// Slots store the full hash, so names are compared only when the hashes already match.
+
+static LangErrors InternTableRehash(InternTable *table, size_t new_capacity);
+static size_t InternProbeStart(const InternTable *table, uint32_t hash);
+
+uint32_t InternHash(const char *name, size_t len) {
+    assert(name);
+
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+LangErrors InternTableCtor(InternTable *table, size_t capacity) {
+    assert(table);
+
+    table->slots    = NULL;
+    table->size     = 0;
+    table->capacity = 0;
+
+    return InternTableReserve(table, capacity);
+}
+
+LangErrors InternTableReserve(InternTable *table, size_t count) {
+    assert(table);
+
+    size_t slots = 16;
+    while (slots < count * 2) {
+        slots *= 2;
+    }
+
+    if (slots <= table->capacity) {
+        return kSuccess;
+    }
+
+    return InternTableRehash(table, slots);
+}
+
+LangErrors InternTableDtor(InternTable *table) {
+    if (!table) {
+        return kSuccess;
+    }
+
+    free(table->slots);
+    table->slots    = NULL;
+    table->size     = 0;
+    table->capacity = 0;
+
+    return kSuccess;
+}
+
+bool InternTableFind(const VariableArr *arr, const char *name, size_t len, uint32_t hash, size_t *pos) {
+    assert(arr);
+    assert(name);
+    assert(pos);
+
+    const InternTable *table = &arr->names;
+    if (table->capacity == 0) {
+        return false;
+    }
+
+    size_t mask = table->capacity - 1;
+    for (size_t i = InternProbeStart(table, hash); table->slots[i].index != 0; i = (i + 1) & mask) {
+        if (table->slots[i].hash != hash) {
+            continue;
+        }
+
+        size_t index = table->slots[i].index - 1;
+        const char *candidate = arr->var_array[index].variable_name;
+        if (candidate && strncmp(candidate, name, len) == 0 && candidate[len] == '\0') {
+            *pos = index;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+LangErrors InternTableInsert(VariableArr *arr, uint32_t hash, size_t pos) {
+    assert(arr);
+
+    InternTable *table = &arr->names;
+
+    if (pos >= UINT32_MAX) {
+        fprintf(stderr, "Too many names for the intern table.\n");
+        return kFailure;
+    }
+
+    if ((table->size + 1) * 2 > table->capacity) {
+        LangErrors err = InternTableRehash(table, table->capacity ? table->capacity * 2 : 16);
+        if (err != kSuccess) {
+            return err;
+        }
+    }
+
+    size_t mask = table->capacity - 1;
+    size_t i = InternProbeStart(table, hash);
+    while (table->slots[i].index != 0) {
+        i = (i + 1) & mask;
+    }
+
+    table->slots[i].hash  = hash;
+    table->slots[i].index = (uint32_t)(pos + 1);
+    table->size++;
+
+    return kSuccess;
+}
+
+static size_t InternProbeStart(const InternTable *table, uint32_t hash) {
+    assert(table);
+
+    return (size_t)hash & (table->capacity - 1);
+}
+
+static LangErrors InternTableRehash(InternTable *table, size_t new_capacity) {
+    assert(table);
+
+    InternSlot *new_slots = (InternSlot *) calloc (new_capacity, sizeof(InternSlot));
+    if (!new_slots) {
+        fprintf(stderr, "Memory error.\n");
+        return kNoMemory;
+    }
+
+    size_t mask = new_capacity - 1;
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->slots[i].index == 0) {
+            continue;
+        }
+
+        size_t j = (size_t)table->slots[i].hash & mask;
+        while (new_slots[j].index != 0) {
+            j = (j + 1) & mask;
+        }
+        new_slots[j] = table->slots[i];
+    }
+
+    free(table->slots);
+    table->slots    = new_slots;
+    table->capacity = new_capacity;
+
+    return kSuccess;
+}
\ No newline at end of file
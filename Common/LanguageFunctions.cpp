@@ -3,7 +3,11 @@
 #include "Common/Enums.h"
 #include "Common/Structs.h"
 #include "Front-End/Rules.h"
-#include "Common/StackFunctions.h"
+#include "Common/InternTable.h"
+#include "Common/Numbers.h"
+#include "Common/Locations.h"
+#include "Common/TreeWalk.h"
+#include "Common/NodeArena.h"
 
 #include <stdio.h>
 #include <assert.h>
@@ -14,22 +18,29 @@
 #define TreeNameFromTable(type) NAME_TYPES_TABLE[type].name_in_tree
 
 static const char *ConvertEnumToOperation(LangNode_t *node, VariableArr *arr);
+static void PrintASTNode(LangNode_t *node, FILE *file, VariableArr *arr, const LocationTable *locations, int indent);
 
 size_t DEFAULT_SIZE = 60;
 
+// The tree reader skips any whitespace, so indentation past this only makes deep trees quadratic.
+static const int MAX_AST_INDENT = 32;
+
 LangErrors LangRootCtor(LangRoot *root) {
     assert(root);
 
     root->root = NULL;
     root->size = 0;
+    root->locations = {};
+    NodeArenaCtor(&root->arena);
 
     return kSuccess;
 }
 
-LangErrors NodeCtor(LangNode_t **node, Value *value) {
+LangErrors NodeCtor(LangRoot *root, LangNode_t **node, Value *value) {
+    assert(root);
     assert(node);
 
-    *node = (LangNode_t *) calloc (1, sizeof(LangNode_t));
+    *node = NodeArenaAlloc(&root->arena);
     if (!*node) {
         fprintf(stderr, "No memory to calloc NODE.\n");
         return kNoMemory;
@@ -55,21 +66,23 @@ LangErrors DeleteNode(LangRoot *root, LangNode_t *node) {
         return kSuccess;
     }
 
-    root->size--;
+    TreeWalk walk = {};
+    LangErrors err = TreeWalkCtor(&walk, &node, 0);
 
-    if (node->left) {
-        DeleteNode(root, node->left);
+    WalkStep step = {};
+    while (TreeWalkNext(&walk, &step)) {
+        if (step.event == kWalkLeave) {
+            root->size--;
+            NodeArenaFree(&root->arena, step.node);
+        }
     }
 
-    if (node->right) {
-        DeleteNode(root, node->right);
+    if (err == kSuccess) {
+        err = walk.error;
     }
+    TreeWalkDtor(&walk);
 
-    //node->parent = NULL;
-    free(node);
-    node = NULL;
-
-    return kSuccess;
+    return err;
 }
 
 LangErrors TreeDtor(LangRoot *tree) {
@@ -77,10 +90,11 @@ LangErrors TreeDtor(LangRoot *tree) {
         return kSuccess;
     }
 
-    DeleteNode(tree, tree->root);
+    NodeArenaDtor(&tree->arena);
 
     tree->root =  NULL;
     tree->size = 0;
+    LocationTableDtor(&tree->locations);
 
     return kSuccess;
 }
@@ -88,55 +102,54 @@ LangErrors TreeDtor(LangRoot *tree) {
 LangErrors InitArrOfVariable(VariableArr *arr, size_t capacity) {
     assert(arr);
 
-    arr->capacity = capacity;
-    arr->size = 0;
+    arr->var_array = NULL;
+    arr->capacity  = 0;
+    arr->size      = 0;
+
+    LangErrors err = InternTableCtor(&arr->names, capacity);
+    if (err != kSuccess) {
+        return err;
+    }
 
-    arr->var_array = (VariableInfo *) calloc (capacity, sizeof(VariableInfo));
-    if (!arr->var_array) {
+    return ReserveVariableArray(arr, capacity);
+}
+
+LangErrors ReserveVariableArray(VariableArr *arr, size_t capacity) {
+    assert(arr);
+
+    if (capacity <= arr->capacity) {
+        return kSuccess;
+    }
+
+    VariableInfo *new_array = (VariableInfo *) realloc (arr->var_array, capacity * sizeof(VariableInfo));
+    if (!new_array) {
         fprintf(stderr, "Memory error.\n");
         return kNoMemory;
     }
 
-    for (size_t i = 0; i < capacity; ++i) {
-        arr->var_array[i].variable_name  = NULL;
-        arr->var_array[i].func_made      = NULL;
-        arr->var_array[i].variable_value = POISON;
-        arr->var_array[i].params_number  = POISON;
-        arr->var_array[i].type           = kUnknown;
+    for (size_t i = arr->capacity; i < capacity; i++) {
+        new_array[i].variable_name  = NULL;
+        new_array[i].func_made      = NULL;
+        new_array[i].variable_value = POISON;
+        new_array[i].params_number  = POISON;
+        new_array[i].pos_in_code    = 0;
+        new_array[i].type           = kUnknown;
     }
-    
-    return kSuccess;
+
+    arr->var_array = new_array;
+    arr->capacity  = capacity;
+
+    return InternTableReserve(&arr->names, capacity);
 }
 
 LangErrors ResizeArray(VariableArr *arr)  {
     assert(arr);
 
-    if (arr->size + 2 > arr->capacity) {
-        arr->capacity += 2;
-        
-        VariableInfo *new_array = (VariableInfo *) calloc (arr->capacity, sizeof(VariableInfo));
-        if (!new_array) {
-            fprintf(stderr, "Memory error.\n");
-            return kNoMemory;
-        }
-        
-        for (size_t i = 0; i < arr->size; i++) {
-            new_array[i] = arr->var_array[i];
-        }
-        
-        for (size_t i = arr->size; i < arr->capacity; i++) {
-            new_array[i].variable_name  = NULL;
-            new_array[i].func_made      = NULL;
-            new_array[i].variable_value = POISON;
-            new_array[i].params_number  = POISON;
-            new_array[i].type           = kUnknown;
-        }
-        
-        free(arr->var_array);
-        arr->var_array = new_array;
+    if (arr->size < arr->capacity) {
+        return kSuccess;
     }
 
-    return kSuccess;
+    return ReserveVariableArray(arr, arr->capacity ? arr->capacity * 2 : 16);
 }
 
 LangErrors DtorVariableArray(VariableArr *arr) {
@@ -154,6 +167,8 @@ LangErrors DtorVariableArray(VariableArr *arr) {
     arr->capacity  = 0;
     arr->size      = 0;
 
+    InternTableDtor(&arr->names);
+
     return kSuccess;
 }
 
@@ -161,7 +176,9 @@ LangNode_t *NewNode(Language *lang_info, NodeTypes type, Value value, LangNode_t
     assert(lang_info);
 
     LangNode_t *new_node = NULL;
-    NodeCtor(&new_node, NULL);
+    if (NodeCtor(lang_info->root, &new_node, NULL) != kSuccess) {
+        return NULL;
+    }
 
     lang_info->root->size++;
     new_node->type = type;
@@ -186,108 +203,196 @@ LangNode_t *NewNode(Language *lang_info, NodeTypes type, Value value, LangNode_t
                 right->parent = new_node;
             }
 
+            break;
+        case kBlock:
+            if (BlockCtor(lang_info->root, new_node) != kSuccess) {
+                return NULL;
+            }
             break;
     }
 
-    if (StackPush(lang_info->tokens, new_node, stderr) != kSuccess) {
-        fprintf(stderr, "Error making new node.\n");
-        return NULL;
-    }
     return new_node;
 }
 
-LangNode_t *NewVariable(Language *lang_info, char *variable) {
+LangNode_t *NewBlock(Language *lang_info) {
     assert(lang_info);
-    assert(variable);
 
-    VariableArr *VariableArr = lang_info->arr;
-    LangNode_t *new_node = NULL;
-    NodeCtor(&new_node, NULL);
+    return NewNode(lang_info, kBlock, (Value){ .block = NULL }, NULL, NULL);
+}
 
-    lang_info->root->size ++;
-    new_node->type = kVariable;
-    size_t pos = 0;
-    bool found_flag = false;
+LangErrors BlockCtor(LangRoot *root, LangNode_t *node) {
+    assert(root);
+    assert(node);
+
+    NodeList *list = NodeArenaAllocList(&root->arena);
+    if (!list) {
+        fprintf(stderr, "No memory to calloc BLOCK.\n");
+        return kNoMemory;
+    }
+
+    node->type = kBlock;
+    node->value.block = list;
+    return kSuccess;
+}
+
+LangErrors BlockAppend(LangNode_t *block, LangNode_t *item) {
+    assert(block);
+    assert(block->type == kBlock);
 
-    for (size_t i = 0; i < VariableArr->size; i++) {
-        const char *name = VariableArr->var_array[i].variable_name;
-        if (name && strcmp(variable, name) == 0) {
-            pos = i;
-            found_flag = true;
+    NodeList *list = block->value.block;
+    if (list->size == list->capacity) {
+        size_t new_capacity = list->capacity ? list->capacity * 2 : 4;
+        LangNode_t **new_items = (LangNode_t **) realloc (list->items, new_capacity * sizeof(LangNode_t *));
+        if (!new_items) {
+            fprintf(stderr, "No memory to grow BLOCK.\n");
+            return kNoMemory;
         }
+
+        list->items    = new_items;
+        list->capacity = new_capacity;
     }
 
-    if (!found_flag) {
-        ResizeArray(VariableArr);
-        VariableArr->var_array[VariableArr->size].variable_name = variable;
-        
-        pos = VariableArr->size;
-        VariableArr->var_array[VariableArr->size].func_made = NULL;
-        VariableArr->size ++;
-    } else {
-        free(variable);
+    list->items[list->size++] = item;
+    if (item) {
+        item->parent = block;
     }
-    
-    new_node->value.pos = pos;
 
-    if (StackPush(lang_info->tokens, new_node, stderr) != kSuccess) {
-        fprintf(stderr, "Error making new node.\n");
+    return kSuccess;
+}
+
+LangErrors InternVariable(VariableArr *arr, const char *name, size_t len, size_t *pos) {
+    assert(arr);
+    assert(name);
+    assert(pos);
+
+    uint32_t hash = InternHash(name, len);
+    if (InternTableFind(arr, name, len, hash, pos)) {
+        return kSuccess;
+    }
+
+    LangErrors err = ResizeArray(arr);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    char *copy = strndup(name, len);
+    if (!copy) {
+        fprintf(stderr, "Memory error.\n");
+        return kNoMemory;
+    }
+
+    err = InternTableInsert(arr, hash, arr->size);
+    if (err != kSuccess) {
+        free(copy);
+        return err;
+    }
+
+    *pos = arr->size;
+    arr->var_array[arr->size].variable_name = copy;
+    arr->var_array[arr->size].func_made = NULL;
+    arr->size++;
+
+    return kSuccess;
+}
+
+LangNode_t *NewVariable(Language *lang_info, const char *name, size_t len) {
+    assert(lang_info);
+    assert(name);
+
+    size_t pos = 0;
+    if (InternVariable(lang_info->arr, name, len, &pos) != kSuccess) {
+        fprintf(stderr, "Error adding new variable.\n");
         return NULL;
     }
-    return new_node;
+
+    return NewNode(lang_info, kVariable, (Value){ .pos = pos }, NULL, NULL);
 }
 
 static void PrintIndent(FILE *file, int indent) {
     assert(file);
 
-    for (int i = 0; i < indent; i++) {
+    for (int i = 0; i < indent && i < MAX_AST_INDENT; i++) {
         fputc('\t', file);
     }
 }
 
-LangErrors PrintAST(LangNode_t *node, FILE *file, VariableArr *arr, int indent) {
+// With `locations`, located nodes get their line:col behind the name.
+LangErrors PrintAST(LangNode_t *node, FILE *file, VariableArr *arr, const LocationTable *locations, int indent) {
     assert(file);
     assert(arr);
 
+    TreeWalk walk = {};
+    LangErrors err = TreeWalkCtor(&walk, &node, kWalkNil);
+
+    WalkStep step = {};
+    while (TreeWalkNext(&walk, &step)) {
+        int depth = indent + (int)step.depth;
+
+        switch (step.event) {
+            case kWalkEnter:
+                PrintASTNode(step.node, file, arr, locations, depth);
+                break;
+            case kWalkBetween:
+                fprintf(file, "\n");
+                break;
+            case kWalkLeave:
+                PrintIndent(file, depth);
+                fprintf(file, ")\n");
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (err == kSuccess) {
+        err = walk.error;
+    }
+    TreeWalkDtor(&walk);
+
+    return err;
+}
+
+static void PrintASTNode(LangNode_t *node, FILE *file, VariableArr *arr, const LocationTable *locations, int indent) {
+    assert(file);
+    assert(arr);
+
+    PrintIndent(file, indent);
     if (!node) {
-        PrintIndent(file, indent);
         fprintf(file, "nil\n");
-        return kSuccess;
+        return;
     }
 
-    PrintIndent(file, indent);
     fprintf(file, "( ");
     
     switch (node->type) {
-        case kNumber:
-            fprintf(file, "\"%.0f\"", node->value.number);
+        case kNumber: {
+            char number[NUMBER_BUF_SIZE] = "";
+            PrintNumber(number, sizeof(number), node->value.number);
+            fprintf(file, "\"%s\"", number);
             break;
+        }
         case kVariable:
             fprintf(file, "\"%s\"", arr->var_array[node->value.pos].variable_name);
             break;
         case kOperation:
             fprintf(file, "\"%s\"", ConvertEnumToOperation(node, arr));
             break;
+        case kBlock:
+            fprintf(file, "\"%s\"", BLOCK_NAME);
+            break;
         default:
             fprintf(file, "\"UNKNOWN\"");
             break;
     }
+
+    size_t line = 0;
+    size_t col  = 0;
+    if (locations && GetLocation(locations, node->loc, &line, &col)) {
+        fprintf(file, " %zu:%zu", line, col);
+    }
     fprintf(file, "\n");
-    
-    PrintAST(node->left, file, arr, indent + 1);
-    
-    // if (node->right) {
-        fprintf(file, "\n");
-        PrintAST(node->right, file, arr, indent + 1);
-    // }
-    
-    PrintIndent(file, indent);
-    fprintf(file, ")\n");
-    
-    return kSuccess;
 }
 
-
 static const char *ConvertEnumToOperation(LangNode_t *node, VariableArr *arr) {
     assert(node);
     assert(arr);
@@ -0,0 +1,126 @@
+#include "Common/Locations.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+// Nodes keep a 32-bit id that fits into the padding after their type, lines and columns
+// live here. The front end numbers entries after tokens, so a node made from token i
+// gets id i + 1; trees read back from an AST file number them after nodes.
+
+static LangErrors LocationTableReserve(LocationTable *table, size_t capacity);
+
+LangErrors AddLocation(LocationTable *table, size_t line, size_t col, uint32_t *loc) {
+    assert(table);
+    assert(loc);
+
+    if (table->size >= UINT32_MAX || line > UINT32_MAX || col > UINT32_MAX) {
+        *loc = 0;
+        return kSuccess;
+    }
+
+    if (table->size == table->capacity) {
+        LangErrors err = LocationTableReserve(table, table->capacity ? table->capacity * 2 : 16);
+        if (err != kSuccess) {
+            return err;
+        }
+    }
+
+    table->line[table->size] = (uint32_t)line;
+    table->col[table->size]  = (uint32_t)col;
+    table->size++;
+
+    *loc = (uint32_t)table->size;
+    return kSuccess;
+}
+
+bool GetLocation(const LocationTable *table, uint32_t loc, size_t *line, size_t *col) {
+    assert(table);
+    assert(line);
+    assert(col);
+
+    if (loc == 0 || loc > table->size) {
+        return false;
+    }
+
+    *line = table->line[loc - 1];
+    *col  = table->col[loc - 1];
+    return true;
+}
+
+// Tokens come in source order, so one pass over the text is enough.
+LangErrors LocateTokens(LocationTable *table, const TokenBuffer *tokens, const char *src) {
+    assert(table);
+    assert(tokens);
+    assert(src);
+
+    table->size = 0;
+    LangErrors err = LocationTableReserve(table, tokens->size);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    size_t line = 1;
+    size_t line_start = 0;
+    size_t cursor = 0;
+
+    for (size_t i = 0; i < tokens->size; i++) {
+        size_t offset = tokens->offset[i];
+        assert(offset >= cursor);
+
+        const char *newline = NULL;
+        while ((newline = (const char *)memchr(src + cursor, '\n', offset - cursor))) {
+            line++;
+            cursor = line_start = (size_t)(newline - src) + 1;
+        }
+        cursor = offset;
+
+        table->line[i] = (uint32_t)line;
+        table->col[i]  = (uint32_t)(offset - line_start + 1);
+    }
+    table->size = tokens->size;
+
+    return kSuccess;
+}
+
+void LocationTableDtor(LocationTable *table) {
+    if (!table) {
+        return;
+    }
+
+    free(table->line);
+    free(table->col);
+
+    table->line     = NULL;
+    table->col      = NULL;
+    table->size     = 0;
+    table->capacity = 0;
+}
+
+static LangErrors LocationTableReserve(LocationTable *table, size_t capacity) {
+    assert(table);
+
+    if (capacity <= table->capacity) {
+        return kSuccess;
+    }
+
+    uint32_t *new_line = (uint32_t *) realloc (table->line, capacity * sizeof(uint32_t));
+    if (!new_line) {
+        return kNoMemory;
+    }
+    table->line = new_line;
+
+    uint32_t *new_col = (uint32_t *) realloc (table->col, capacity * sizeof(uint32_t));
+    if (!new_col) {
+        return kNoMemory;
+    }
+    table->col = new_col;
+
+    table->capacity = capacity;
+    return kSuccess;
+}
\ No newline at end of file
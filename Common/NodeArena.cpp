@@ -0,0 +1,156 @@
+#include "Common/NodeArena.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+// Nodes of one tree are cut from chunks that only go away all together, so a node costs
+// a pointer bump and the teardown one free per chunk. Chunks double up to a limit. Nodes
+// the optimiser drops wait on a free list for the next allocation.
+
+static const size_t FIRST_CHUNK_NODES = 256;
+static const size_t MAX_CHUNK_NODES   = 65536;
+
+static NodeChunk *NodeArenaGrow(NodeArena *arena);
+
+void NodeArenaCtor(NodeArena *arena) {
+    assert(arena);
+
+    arena->chunks     = NULL;
+    arena->free_list  = NULL;
+    arena->lists      = NULL;
+}
+
+void NodeArenaDtor(NodeArena *arena) {
+    if (!arena) {
+        return;
+    }
+
+    while (arena->lists) {
+        NodeList *next = arena->lists->next;
+        free(arena->lists->items);
+        free(arena->lists);
+        arena->lists = next;
+    }
+
+    while (arena->chunks) {
+        NodeChunk *next = arena->chunks->next;
+        free(arena->chunks);
+        arena->chunks = next;
+    }
+
+    NodeArenaCtor(arena);
+}
+
+LangNode_t *NodeArenaAlloc(NodeArena *arena) {
+    assert(arena);
+
+    LangNode_t *node = arena->free_list;
+    if (node) {
+        arena->free_list = node->right;
+    } else {
+        NodeChunk *chunk = arena->chunks;
+        if (!chunk || chunk->used == chunk->capacity) {
+            chunk = NodeArenaGrow(arena);
+            if (!chunk) {
+                return NULL;
+            }
+        }
+
+        node = &chunk->nodes[chunk->used++];
+    }
+
+    *node = {};
+    return node;
+}
+
+void NodeArenaFree(NodeArena *arena, LangNode_t *node) {
+    assert(arena);
+    if (!node) return;
+
+    node->right = arena->free_list;
+    arena->free_list = node;
+}
+
+// Item lists of blocks stay until the arena goes, a block given back keeps its list.
+NodeList *NodeArenaAllocList(NodeArena *arena) {
+    assert(arena);
+
+    NodeList *list = (NodeList *) calloc (1, sizeof(NodeList));
+    if (!list) {
+        return NULL;
+    }
+
+    list->next = arena->lists;
+    arena->lists = list;
+    return list;
+}
+
+// Everything of `from` is handed over and `from` is left empty. Its chunks go behind the
+// one `arena` cuts from, so that one is not left half used.
+void NodeArenaAdopt(NodeArena *arena, NodeArena *from) {
+    assert(arena);
+    assert(from);
+
+    if (from->chunks) {
+        NodeChunk *last = from->chunks;
+        while (last->next) {
+            last = last->next;
+        }
+
+        if (arena->chunks) {
+            last->next = arena->chunks->next;
+            arena->chunks->next = from->chunks;
+        } else {
+            arena->chunks = from->chunks;
+        }
+    }
+
+    if (from->lists) {
+        NodeList *last = from->lists;
+        while (last->next) {
+            last = last->next;
+        }
+
+        last->next = arena->lists;
+        arena->lists = from->lists;
+    }
+
+    if (from->free_list) {
+        LangNode_t *last = from->free_list;
+        while (last->right) {
+            last = last->right;
+        }
+
+        last->right = arena->free_list;
+        arena->free_list = from->free_list;
+    }
+
+    NodeArenaCtor(from);
+}
+
+static NodeChunk *NodeArenaGrow(NodeArena *arena) {
+    assert(arena);
+
+    size_t capacity = arena->chunks ? arena->chunks->capacity * 2 : FIRST_CHUNK_NODES;
+    if (capacity > MAX_CHUNK_NODES) {
+        capacity = MAX_CHUNK_NODES;
+    }
+
+    NodeChunk *chunk = (NodeChunk *) malloc (sizeof(NodeChunk) + capacity * sizeof(LangNode_t));
+    if (!chunk) {
+        fprintf(stderr, "No memory for %zu more nodes.\n", capacity);
+        return NULL;
+    }
+
+    chunk->next     = arena->chunks;
+    chunk->nodes    = (LangNode_t *)(chunk + 1);
+    chunk->used     = 0;
+    chunk->capacity = capacity;
+
+    arena->chunks = chunk;
+    return chunk;
+}
\ No newline at end of file
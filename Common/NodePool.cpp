@@ -0,0 +1,535 @@
+#include "Common/NodePool.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+#include "Common/LanguageFunctions.h"
+#include "Common/TreeWalk.h"
+
+// The tree laid out as parallel arrays indexed by 32-bit ids: a node takes 25 bytes instead
+// of the 40 of a LangNode_t, and a pass reading one field reads it for the neighbours too.
+// Pools are filled in preorder, so the descendants of a node always have greater ids.
+// Nodes cut out of the tree stay in the arrays until the next NodePoolCompact.
+
+static const size_t FIRST_POOL_NODES = 256;
+static const size_t FIRST_POOL_ITEMS = 64;
+
+static LangErrors NodePoolReserve(NodePool *pool, size_t capacity);
+static LangErrors NodePoolReserveItems(NodePool *pool, size_t capacity);
+static uint32_t NodePoolAddFromTree(NodePool *pool, const LangNode_t *node);
+static LangErrors NodeFromPool(const NodePool *pool, uint32_t id, LangRoot *tree, LangNode_t **node);
+
+static LangErrors PushPoolFrame(PoolFrame **frames, size_t *size, size_t *capacity, uint32_t id, LangNode_t *node);
+static LangErrors PushPoolId(uint32_t **ids, size_t *size, size_t *capacity, uint32_t id);
+
+LangErrors NodePoolCtor(NodePool *pool, size_t capacity) {
+    assert(pool);
+
+    *pool = {};
+    LangErrors err = NodePoolReserve(pool, capacity + 1 > FIRST_POOL_NODES ? capacity + 1 : FIRST_POOL_NODES);
+    if (err != kSuccess) {
+        NodePoolDtor(pool);
+        return err;
+    }
+
+    pool->kind[0]   = kNumber;
+    pool->value[0]  = {};
+    pool->left[0]   = pool->right[0] = pool->parent[0] = 0;
+    pool->loc[0]    = 0;
+    pool->size      = 1;
+
+    return kSuccess;
+}
+
+void NodePoolDtor(NodePool *pool) {
+    if (!pool) {
+        return;
+    }
+
+    free(pool->kind);
+    free(pool->value);
+    free(pool->left);
+    free(pool->right);
+    free(pool->parent);
+    free(pool->loc);
+    free(pool->items);
+
+    *pool = {};
+}
+
+uint32_t NodePoolAdd(NodePool *pool, NodeTypes type, Value value, uint32_t left, uint32_t right) {
+    assert(pool);
+    assert(pool->size);
+
+    if (pool->size == UINT32_MAX) {
+        fprintf(stderr, "Too many nodes for the pool.\n");
+        return 0;
+    }
+    if (pool->size == pool->capacity && NodePoolReserve(pool, pool->capacity * 2) != kSuccess) {
+        return 0;
+    }
+
+    uint32_t id = (uint32_t) pool->size++;
+    pool->kind[id]   = (unsigned char) type;
+    pool->value[id]  = value;
+    pool->left[id]   = left;
+    pool->right[id]  = right;
+    pool->parent[id] = 0;
+    pool->loc[id]    = 0;
+
+    if (left) {
+        pool->parent[left] = id;
+    }
+    if (right) {
+        pool->parent[right] = id;
+    }
+
+    return id;
+}
+
+// The block gets `count` empty item slots.
+uint32_t NodePoolAddBlock(NodePool *pool, size_t count) {
+    assert(pool);
+
+    if (count >= UINT32_MAX || NodePoolReserveItems(pool, pool->items_size + count + 1) != kSuccess) {
+        return 0;
+    }
+
+    Value value = {};
+    value.pos = pool->items_size;
+
+    uint32_t id = NodePoolAdd(pool, kBlock, value, 0, 0);
+    if (!id) {
+        return 0;
+    }
+
+    pool->items[pool->items_size] = (uint32_t) count;
+    memset(&pool->items[pool->items_size + 1], 0, count * sizeof(uint32_t));
+    pool->items_size += count + 1;
+
+    return id;
+}
+
+uint32_t *NodePoolItems(const NodePool *pool, uint32_t block, size_t *count) {
+    assert(pool);
+    assert(count);
+    assert(pool->kind[block] == kBlock);
+
+    uint32_t *run = &pool->items[pool->value[block].pos];
+    *count = run[0];
+    return run + 1;
+}
+
+// Hangs `with` where `node` hung, `node` is left out of the tree.
+void NodePoolReplace(NodePool *pool, uint32_t node, uint32_t with, uint32_t *root) {
+    assert(pool);
+    assert(node);
+    assert(root);
+
+    uint32_t parent = pool->parent[node];
+    if (with) {
+        pool->parent[with] = parent;
+    }
+
+    if (!parent) {
+        assert(*root == node);
+        *root = with;
+        return;
+    }
+
+    if (pool->kind[parent] == kBlock) {
+        size_t count = 0;
+        uint32_t *items = NodePoolItems(pool, parent, &count);
+        for (size_t i = 0; i < count; i++) {
+            if (items[i] == node) {
+                items[i] = with;
+                break;
+            }
+        }
+    } else if (pool->left[parent] == node) {
+        pool->left[parent] = with;
+    } else {
+        pool->right[parent] = with;
+    }
+}
+
+LangErrors NodePoolFromTree(NodePool *pool, LangNode_t *root, uint32_t *root_id) {
+    assert(pool);
+    assert(root_id);
+
+    *root_id = 0;
+    if (!root) {
+        return kSuccess;
+    }
+
+    TreeWalk walk = {};
+    LangErrors err = TreeWalkCtor(&walk, &root, 0);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    uint32_t *ids = NULL; // of the nodes entered on the way down, by depth
+    size_t ids_size = 0;
+    size_t ids_capacity = 0;
+
+    WalkStep step = {};
+    while (err == kSuccess && TreeWalkNext(&walk, &step)) {
+        if (step.event != kWalkEnter) {
+            continue;
+        }
+
+        uint32_t id = NodePoolAddFromTree(pool, step.node);
+        if (!id) {
+            err = kNoMemory;
+            break;
+        }
+
+        ids_size = step.depth;
+        err = PushPoolId(&ids, &ids_size, &ids_capacity, id);
+        if (!step.parent) {
+            *root_id = id;
+            continue;
+        }
+
+        uint32_t parent = ids[step.depth - 1];
+        pool->parent[id] = parent;
+
+        if (step.parent->type == kBlock) {
+            size_t count = 0;
+            uint32_t *items = NodePoolItems(pool, parent, &count);
+            items[step.link - step.parent->value.block->items] = id;
+        } else if (step.link == &step.parent->left) {
+            pool->left[parent] = id;
+        } else {
+            pool->right[parent] = id;
+        }
+    }
+
+    if (err == kSuccess) {
+        err = walk.error;
+    }
+    TreeWalkDtor(&walk);
+    free(ids);
+
+    return err;
+}
+
+// Makes LangNode_t copies of the subtree under `id` in `tree`.
+LangErrors NodePoolToTree(const NodePool *pool, uint32_t id, LangRoot *tree, LangNode_t **node) {
+    assert(pool);
+    assert(tree);
+    assert(node);
+
+    *node = NULL;
+    if (!id) {
+        return kSuccess;
+    }
+
+    PoolFrame *frames = NULL;
+    size_t size = 0;
+    size_t capacity = 0;
+
+    LangErrors err = NodeFromPool(pool, id, tree, node);
+    if (err == kSuccess) {
+        err = PushPoolFrame(&frames, &size, &capacity, id, *node);
+    }
+
+    while (err == kSuccess && size) {
+        PoolFrame frame = frames[--size];
+
+        if (pool->kind[frame.id] == kBlock) {
+            size_t count = 0;
+            const uint32_t *items = NodePoolItems(pool, frame.id, &count);
+
+            for (size_t i = 0; i < count && err == kSuccess; i++) {
+                LangNode_t *item = NULL;
+                err = NodeFromPool(pool, items[i], tree, &item);
+                if (err == kSuccess) {
+                    err = BlockAppend(frame.node, item);
+                }
+            }
+
+            LangNode_t **made = frame.node->value.block->items;
+            for (size_t i = count; i > 0 && err == kSuccess; i--) {
+                if (items[i - 1]) {
+                    err = PushPoolFrame(&frames, &size, &capacity, items[i - 1], made[i - 1]);
+                }
+            }
+            continue;
+        }
+
+        uint32_t left  = pool->left[frame.id];
+        uint32_t right = pool->right[frame.id];
+
+        err = NodeFromPool(pool, left, tree, &frame.node->left);
+        if (err == kSuccess) {
+            err = NodeFromPool(pool, right, tree, &frame.node->right);
+        }
+        if (err != kSuccess) {
+            break;
+        }
+
+        if (right) {
+            frame.node->right->parent = frame.node;
+            err = PushPoolFrame(&frames, &size, &capacity, right, frame.node->right);
+        }
+        if (left && err == kSuccess) {
+            frame.node->left->parent = frame.node;
+            err = PushPoolFrame(&frames, &size, &capacity, left, frame.node->left);
+        }
+    }
+
+    free(frames);
+    return err;
+}
+
+// Lays the nodes still in the tree under `root` out again in preorder and drops the rest.
+LangErrors NodePoolCompact(NodePool *pool, uint32_t *root) {
+    assert(pool);
+    assert(root);
+
+    uint32_t *moved = (uint32_t *) calloc (pool->size, sizeof(uint32_t));
+    if (!moved) {
+        fprintf(stderr, "No memory to compact the pool.\n");
+        return kNoMemory;
+    }
+
+    uint32_t *stack = NULL;
+    size_t stack_size = 0;
+    size_t stack_capacity = 0;
+    size_t count = 0;
+    size_t items_count = 0;
+
+    LangErrors err = kSuccess;
+    if (*root) {
+        err = PushPoolId(&stack, &stack_size, &stack_capacity, *root);
+    }
+
+    while (err == kSuccess && stack_size) {
+        uint32_t id = stack[--stack_size];
+        moved[id] = (uint32_t) ++count;
+
+        if (pool->kind[id] == kBlock) {
+            size_t items_size = 0;
+            const uint32_t *items = NodePoolItems(pool, id, &items_size);
+            items_count += items_size + 1;
+
+            for (size_t i = items_size; i > 0 && err == kSuccess; i--) {
+                if (items[i - 1]) {
+                    err = PushPoolId(&stack, &stack_size, &stack_capacity, items[i - 1]);
+                }
+            }
+        } else {
+            if (pool->right[id]) {
+                err = PushPoolId(&stack, &stack_size, &stack_capacity, pool->right[id]);
+            }
+            if (pool->left[id] && err == kSuccess) {
+                err = PushPoolId(&stack, &stack_size, &stack_capacity, pool->left[id]);
+            }
+        }
+    }
+    free(stack);
+
+    NodePool compact = {};
+    if (err == kSuccess) {
+        err = NodePoolCtor(&compact, count);
+    }
+    if (err == kSuccess) {
+        err = NodePoolReserveItems(&compact, items_count);
+    }
+    if (err != kSuccess) {
+        NodePoolDtor(&compact);
+        free(moved);
+        return err;
+    }
+
+    for (size_t id = 1; id < pool->size; id++) {
+        uint32_t to = moved[id];
+        if (!to) {
+            continue;
+        }
+
+        compact.kind[to]   = pool->kind[id];
+        compact.value[to]  = pool->value[id];
+        compact.left[to]   = moved[pool->left[id]];
+        compact.right[to]  = moved[pool->right[id]];
+        compact.parent[to] = moved[pool->parent[id]];
+        compact.loc[to]    = pool->loc[id];
+
+        if (pool->kind[id] == kBlock) {
+            size_t items_size = 0;
+            const uint32_t *items = NodePoolItems(pool, (uint32_t) id, &items_size);
+
+            compact.value[to].pos = compact.items_size;
+            compact.items[compact.items_size++] = (uint32_t) items_size;
+            for (size_t i = 0; i < items_size; i++) {
+                compact.items[compact.items_size++] = moved[items[i]];
+            }
+        }
+    }
+    compact.size = count + 1;
+
+    *root = moved[*root];
+    free(moved);
+
+    NodePoolDtor(pool);
+    *pool = compact;
+
+    return kSuccess;
+}
+
+static LangErrors NodePoolReserve(NodePool *pool, size_t capacity) {
+    assert(pool);
+
+    if (capacity <= pool->capacity) {
+        return kSuccess;
+    }
+
+    unsigned char *kind = (unsigned char *) realloc (pool->kind, capacity * sizeof(unsigned char));
+    if (kind) {
+        pool->kind = kind;
+    }
+    Value *value = (Value *) realloc (pool->value, capacity * sizeof(Value));
+    if (value) {
+        pool->value = value;
+    }
+    uint32_t *left = (uint32_t *) realloc (pool->left, capacity * sizeof(uint32_t));
+    if (left) {
+        pool->left = left;
+    }
+    uint32_t *right = (uint32_t *) realloc (pool->right, capacity * sizeof(uint32_t));
+    if (right) {
+        pool->right = right;
+    }
+    uint32_t *parent = (uint32_t *) realloc (pool->parent, capacity * sizeof(uint32_t));
+    if (parent) {
+        pool->parent = parent;
+    }
+    uint32_t *loc = (uint32_t *) realloc (pool->loc, capacity * sizeof(uint32_t));
+    if (loc) {
+        pool->loc = loc;
+    }
+
+    if (!kind || !value || !left || !right || !parent || !loc) {
+        fprintf(stderr, "No memory for %zu pool nodes.\n", capacity);
+        return kNoMemory;
+    }
+
+    pool->capacity = capacity;
+    return kSuccess;
+}
+
+static LangErrors NodePoolReserveItems(NodePool *pool, size_t capacity) {
+    assert(pool);
+
+    if (capacity <= pool->items_capacity) {
+        return kSuccess;
+    }
+
+    size_t new_capacity = pool->items_capacity ? pool->items_capacity * 2 : FIRST_POOL_ITEMS;
+    if (new_capacity < capacity) {
+        new_capacity = capacity;
+    }
+
+    uint32_t *items = (uint32_t *) realloc (pool->items, new_capacity * sizeof(uint32_t));
+    if (!items) {
+        fprintf(stderr, "No memory for %zu block items.\n", new_capacity);
+        return kNoMemory;
+    }
+
+    pool->items = items;
+    pool->items_capacity = new_capacity;
+    return kSuccess;
+}
+
+static uint32_t NodePoolAddFromTree(NodePool *pool, const LangNode_t *node) {
+    assert(pool);
+    assert(node);
+
+    uint32_t id = 0;
+    if (node->type == kBlock) {
+        id = NodePoolAddBlock(pool, node->value.block ? node->value.block->size : 0);
+    } else {
+        id = NodePoolAdd(pool, node->type, node->value, 0, 0);
+    }
+
+    if (id) {
+        pool->loc[id] = node->loc;
+    }
+    return id;
+}
+
+static LangErrors NodeFromPool(const NodePool *pool, uint32_t id, LangRoot *tree, LangNode_t **node) {
+    assert(pool);
+    assert(tree);
+    assert(node);
+
+    *node = NULL;
+    if (!id) {
+        return kSuccess;
+    }
+
+    Value value = pool->value[id];
+    LangErrors err = NodeCtor(tree, node, &value);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    (*node)->type = (NodeTypes) pool->kind[id];
+    (*node)->loc  = pool->loc[id];
+    tree->size++;
+
+    if ((*node)->type == kBlock) {
+        return BlockCtor(tree, *node);
+    }
+    return kSuccess;
+}
+
+static LangErrors PushPoolFrame(PoolFrame **frames, size_t *size, size_t *capacity, uint32_t id, LangNode_t *node) {
+    assert(frames);
+    assert(size);
+    assert(capacity);
+
+    if (*size == *capacity) {
+        size_t new_capacity = *capacity ? *capacity * 2 : 64;
+        PoolFrame *new_frames = (PoolFrame *) realloc (*frames, new_capacity * sizeof(PoolFrame));
+        if (!new_frames) {
+            fprintf(stderr, "No memory to walk the pool.\n");
+            return kNoMemory;
+        }
+
+        *frames = new_frames;
+        *capacity = new_capacity;
+    }
+
+    (*frames)[*size].id   = id;
+    (*frames)[*size].node = node;
+    (*size)++;
+
+    return kSuccess;
+}
+
+static LangErrors PushPoolId(uint32_t **ids, size_t *size, size_t *capacity, uint32_t id) {
+    assert(ids);
+    assert(size);
+    assert(capacity);
+
+    if (*size == *capacity) {
+        size_t new_capacity = *capacity ? *capacity * 2 : 64;
+        uint32_t *new_ids = (uint32_t *) realloc (*ids, new_capacity * sizeof(uint32_t));
+        if (!new_ids) {
+            fprintf(stderr, "No memory to walk the pool.\n");
+            return kNoMemory;
+        }
+
+        *ids = new_ids;
+        *capacity = new_capacity;
+    }
+
+    (*ids)[(*size)++] = id;
+    return kSuccess;
+}
\ No newline at end of file
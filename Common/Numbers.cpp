@@ -0,0 +1,134 @@
+#include "Common/Numbers.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <math.h>
+#include <charconv>
+#include <system_error>
+
+// Literals are -?digits(.digits)?([eE][+-]?digits)?, the lexers and the tree reader
+// all go through here. Integral values below 1e15 are printed without an exponent,
+// which keeps integer programs byte-identical, the rest as the shortest string that
+// reads back to the same double.
+
+#define MAX_PLAIN_INTEGER 1e15
+
+static inline bool IsDigit(char c);
+static const char *SkipDigits(const char *ptr);
+
+// Stops at the first byte that cannot continue the literal, so `string` only has to be
+// terminated by something that is not a digit. NULL when there is no literal or it does
+// not fit into a double.
+const char *ScanNumber(const char *string, double *number) {
+    assert(string);
+    assert(number);
+
+    const char *ptr = string + (*string == '-');
+    if (!IsDigit(*ptr)) {
+        return NULL;
+    }
+    ptr = SkipDigits(ptr);
+
+    if (ptr[0] == '.' && IsDigit(ptr[1])) {
+        ptr = SkipDigits(ptr + 1);
+    }
+
+    if (ptr[0] == 'e' || ptr[0] == 'E') {
+        const char *exponent = ptr + 1 + (ptr[1] == '+' || ptr[1] == '-');
+        if (IsDigit(*exponent)) {
+            ptr = SkipDigits(exponent);
+        }
+    }
+
+    return ParseNumber(string, ptr, number) ? ptr : NULL;
+}
+
+bool ParseNumber(const char *begin, const char *end, double *number) {
+    assert(begin);
+    assert(end);
+    assert(number);
+
+    std::from_chars_result res = std::from_chars(begin, end, *number, std::chars_format::general);
+
+    return res.ec == std::errc() && res.ptr == end;
+}
+
+size_t PrintNumber(char *buf, size_t size, double number) {
+    assert(buf);
+    assert(size > 0);
+
+    std::to_chars_result res = {};
+    if (fabs(number) < MAX_PLAIN_INTEGER && !islessgreater(trunc(number), number)) {
+        res = std::to_chars(buf, buf + size - 1, number, std::chars_format::fixed);
+    } else {
+        res = std::to_chars(buf, buf + size - 1, number);
+    }
+
+    if (res.ec != std::errc()) {
+        buf[0] = '\0';
+        return 0;
+    }
+
+    *res.ptr = '\0';
+    return (size_t)(res.ptr - buf);
+}
+
+// Unary functions take their operand from the side the tree keeps it on.
+double EvaluateOperation(OperationTypes operation, double left, double right) {
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wswitch-enum"
+    switch (operation) {
+    case (kOperationAdd):
+        return left + right;
+    case (kOperationSub):
+        return left - right;
+    case (kOperationMul):
+        return left * right;
+    case (kOperationDiv):
+        if (fabs(right) < eps) {
+            fprintf(stderr, "Division by zero.\n");
+            return 0;
+        }
+        return left / right;
+    case (kOperationPow):
+        return pow(left, right);
+    case (kOperationSin):
+        return sin(right);
+    case (kOperationCos):
+        return cos(right);
+    case (kOperationTg):
+        return tan(right);
+    case (kOperationLn):
+        return log(right);
+    case (kOperationArctg):
+        return atan(right);
+    case (kOperationSinh):
+        return sinh(right);    
+    case (kOperationCosh):
+        return cosh(right);
+    case (kOperationTgh):
+        return tanh(right);
+    case (kOperationSQRT):
+        return sqrt(left);
+
+    case (kOperationNone):
+    default:
+        fprintf(stderr, "Unknown operation: %d.\n", operation);
+        return 0;
+    }
+    #pragma GCC diagnostic pop
+}
+
+static inline bool IsDigit(char c) {
+    return '0' <= c && c <= '9';
+}
+
+static const char *SkipDigits(const char *ptr) {
+    assert(ptr);
+
+    while (IsDigit(*ptr)) {
+        ptr++;
+    }
+
+    return ptr;
+}
\ No newline at end of file
@@ -12,12 +12,18 @@
 #include "Front-End/Rules.h"
 #include "Common/LanguageFunctions.h"
 #include "Common/CommonFunctions.h"
-#include "Common/StackFunctions.h"
+#include "Common/Numbers.h"
+#include "Common/Locations.h"
+#include "Common/TreeWalk.h"
+#include "Common/NodeArena.h"
 
-static LangErrors CheckType(Lang_t title, LangNode_t *node, VariableArr *Variable_Array);
+static LangErrors CheckType(Lang_t title, LangNode_t *node, LangRoot *tree, VariableArr *Variable_Array);
 static LangErrors ParseTitle(const char *buffer, size_t *pos, char **out_title);
 static LangErrors ParseMaybeNil(const char *buffer, size_t *pos, LangNode_t **out);
 static LangErrors ExpectClosingParen(const char *buffer, size_t *pos);
+static LangErrors ExpectBlockItem(const char *buffer, size_t *pos, LangNode_t *block);
+static LangErrors ParseLocation(const char *buffer, size_t *pos, LangNode_t *node, LocationTable *locations);
+static LangErrors ParseNodeOpening(const char *buffer, size_t *pos, LangNode_t *parent, LangNode_t **node_to_add, VariableArr *Variable_Array, LangRoot *tree);
 
 static int CountArgs(LangNode_t *args_root);
 static void RegisterInit(LangNode_t *func_name_node, LangNode_t *var_node, VariableArr *Variable_Array);
@@ -31,11 +37,58 @@ static LangErrors TrySetOperation(Lang_t title, LangNode_t *node);
 static LangErrors TrySetNumber(Lang_t title, LangNode_t *node);
 static LangErrors TrySetVariable(Lang_t title, LangNode_t *node, VariableArr *Variable_Array);
 
-LangErrors ParseNodeFromString(const char *buffer, size_t *pos, LangNode_t *parent, LangNode_t **node_to_add, VariableArr *Variable_Array) {
+// Nodes come from the arena of `tree`, the subtree read is hung on `node_to_add`.
+LangErrors ParseNodeFromString(const char *buffer, size_t *pos, LangNode_t *parent, LangNode_t **node_to_add, VariableArr *Variable_Array, LangRoot *tree) {
     assert(buffer);
     assert(pos);
     assert(node_to_add);
     assert(Variable_Array);
+    assert(tree);
+
+    LangNode_t *top = NULL;
+    TreeWalk walk = {};
+    LangErrors err = TreeWalkCtor(&walk, &top, kWalkNil);
+
+    WalkStep step = {};
+    while (err == kSuccess && TreeWalkNext(&walk, &step)) {
+        if (step.event == kWalkEnter) {
+            err = ParseNodeOpening(buffer, pos, step.parent ? step.parent : parent, step.link, Variable_Array, tree);
+            if (err == kSuccess && *step.link && (*step.link)->type == kBlock) {
+                err = ExpectBlockItem(buffer, pos, *step.link);
+            } else if (err == kSuccess && !*step.link && step.parent && step.parent->type == kBlock) {
+                err = ExpectBlockItem(buffer, pos, step.parent);
+            }
+        } else if (step.event == kWalkLeave) {
+            if (IsThatOperation(step.node, kOperationFunction)) {
+                ComputeFuncSizes(step.node, Variable_Array);
+            }
+            err = ExpectClosingParen(buffer, pos);
+            if (err == kSuccess && step.parent && step.parent->type == kBlock) {
+                err = ExpectBlockItem(buffer, pos, step.parent);
+            }
+        }
+    }
+
+    if (err == kSuccess) {
+        err = walk.error;
+    }
+    TreeWalkDtor(&walk);
+
+    if (err != kSuccess) {
+        return err;
+    }
+
+    *node_to_add = top;
+    return kSuccess;
+}
+
+// Reads "nil" or the "( title [line:col]" head of a node, its children come next.
+static LangErrors ParseNodeOpening(const char *buffer, size_t *pos, LangNode_t *parent, LangNode_t **node_to_add, VariableArr *Variable_Array, LangRoot *tree) {
+    assert(buffer);
+    assert(pos);
+    assert(node_to_add);
+    assert(Variable_Array);
+    assert(tree);
 
     LangErrors err = ParseMaybeNil(buffer, pos, node_to_add);
     if (err == kSuccess) {
@@ -49,29 +102,23 @@ LangErrors ParseNodeFromString(const char *buffer, size_t *pos, LangNode_t *pare
     }
 
     LangNode_t *node = NULL;
-    NodeCtor(&node, NULL);
+    err = NodeCtor(tree, &node, NULL);
+    if (err != kSuccess) {
+        free(title);
+        return err;
+    }
     node->parent = parent;
 
-    err = CheckType(title, node, Variable_Array);
+    err = CheckType(title, node, tree, Variable_Array);
     free(title);
+    if (err == kSuccess) {
+        err = ParseLocation(buffer, pos, node, &tree->locations);
+    }
     if (err != kSuccess) {
+        NodeArenaFree(&tree->arena, node);
         return err;
     }
 
-    LangNode_t *left = NULL;
-    CHECK_ERROR_RETURN(ParseNodeFromString(buffer, pos, node, &left, Variable_Array), NULL, NULL, NULL);
-    node->left = left;
-
-    LangNode_t *right = NULL;
-    CHECK_ERROR_RETURN(ParseNodeFromString(buffer, pos, node, &right, Variable_Array), NULL, NULL, NULL);
-    node->right = right;
-
-    if (IsThatOperation(node, kOperationFunction)) {
-        ComputeFuncSizes(node, Variable_Array);
-    }
-
-    CHECK_ERROR_RETURN(ExpectClosingParen(buffer, pos), NULL, NULL, NULL);
-
     *node_to_add = node;
     return kSuccess;
 }
@@ -80,25 +127,36 @@ static void ComputeFuncSizes(LangNode_t *node, VariableArr *Variable_Array) {
     assert(Variable_Array);
     if (!node) return;
 
-    ComputeFuncSizes(node->left, Variable_Array);
-    ComputeFuncSizes(node->right, Variable_Array);
+    TreeWalk walk = {};
+    TreeWalkCtor(&walk, &node, 0);
 
-    if (IsThatOperation(node, kOperationFunction)) {
-        LangNode_t *func_name = node->left;
-        LangNode_t *args_root = node->right ? node->right->left  : NULL;
-        LangNode_t *body_root = node->right ? node->right->right : NULL;
+    WalkStep step = {};
+    while (TreeWalkNext(&walk, &step)) {
+        if (step.event != kWalkLeave || !IsThatOperation(step.node, kOperationFunction)) {
+            continue;
+        }
+
+        LangNode_t *func_name = step.node->left;
+        LangNode_t *args_root = step.node->right ? step.node->right->left  : NULL;
+        LangNode_t *body_root = step.node->right ? step.node->right->right : NULL;
 
         int argc = CountArgs(args_root);
         Variable_Array->var_array[func_name->value.pos].variable_value = argc;
         ScanInitsInSubtree(func_name, body_root, Variable_Array);
     }
+    TreeWalkDtor(&walk);
 }
 
-static LangErrors CheckType(Lang_t title, LangNode_t *node, VariableArr *Variable_Array) {
+static LangErrors CheckType(Lang_t title, LangNode_t *node, LangRoot *tree, VariableArr *Variable_Array) {
     assert(title);
     assert(node);
+    assert(tree);
     assert(Variable_Array);
     
+    if (strcmp(title, BLOCK_NAME) == 0) {
+        return BlockCtor(tree, node);
+    }
+
     LangErrors is_operation = TrySetOperation(title, node);
     if (is_operation == kSuccess) {
         return kSuccess;
@@ -130,46 +188,34 @@ static LangErrors TrySetNumber(Lang_t title, LangNode_t *node) {
     assert(title);
     assert(node);
 
-    bool is_num = true;
-    for (size_t k = 0; title[k]; k++) {
-        if (!isdigit(title[k]) && title[k] != '.' && title[k] != '-') {
-            is_num = false;
-            break;
-        }
+    double number = 0;
+    const char *end = ScanNumber(title, &number);
+    if (!end || *end != '\0') {
+        return kFailure;
     }
 
-    if (is_num) {
-        node->type = kNumber;
-        node->value.number = atof(title);
-        return kSuccess;
-    }
-
-    return kFailure;
+    node->type = kNumber;
+    node->value.number = number;
+    return kSuccess;
 }
 
 static LangErrors TrySetVariable(Lang_t title, LangNode_t *node, VariableArr *Variable_Array) {
     assert(node);
     assert(Variable_Array);
 
-    for (size_t j = 0; j < Variable_Array->size; j++) {
-        if (strcmp(Variable_Array->var_array[j].variable_name, title) == 0) {
-            node->value.pos = j;
-            return kSuccess;
-        }
-    }
+    size_t old_size = Variable_Array->size;
+    size_t pos = 0;
 
-    if (Variable_Array->size >= Variable_Array->capacity) {
-        return kNoMemory;
+    LangErrors err = InternVariable(Variable_Array, title, strlen(title), &pos);
+    if (err != kSuccess) {
+        return err;
     }
 
-    ResizeArray(Variable_Array);
-    Variable_Array->var_array[Variable_Array->size].variable_name = strdup(title);
-    Variable_Array->var_array[Variable_Array->size].variable_value = 0;
-    Variable_Array->var_array[Variable_Array->size].func_made = NULL;
-
-    node->value.pos = Variable_Array->size;
-    Variable_Array->size++;
+    if (Variable_Array->size != old_size) {
+        Variable_Array->var_array[pos].variable_value = 0;
+    }
 
+    node->value.pos = pos;
     return kSuccess;
 }
 
@@ -178,11 +224,20 @@ static int CountArgs(LangNode_t *args_root) {
         return 0;
     }
 
-    if (IsThatOperation(args_root, kOperationComma)) {
-        return CountArgs(args_root->left) + CountArgs(args_root->right);
+    int count = 0;
+    TreeWalk walk = {};
+    TreeWalkCtor(&walk, &args_root, 0);
+
+    WalkStep step = {};
+    while (TreeWalkNext(&walk, &step)) {
+        if (step.event == kWalkEnter && !IsThatOperation(step.node, kOperationComma)) {
+            count++;
+            TreeWalkSkip(&walk);
+        }
     }
+    TreeWalkDtor(&walk);
 
-    return 1;
+    return count;
 }
 
 static void RegisterInit(LangNode_t *func_name_node, LangNode_t *var_node, VariableArr *Variable_Array) {
@@ -204,12 +259,17 @@ static void ScanInitsInSubtree(LangNode_t *func_name_node, LangNode_t *root, Var
     assert(Variable_Array);
     if (!root) return;
 
-    if (IsThatOperation(root, kOperationIs) && root->left && root->left->type == kVariable) {
-        RegisterInit(func_name_node, root->left, Variable_Array);
-    }
+    TreeWalk walk = {};
+    TreeWalkCtor(&walk, &root, 0);
 
-    ScanInitsInSubtree(func_name_node, root->left, Variable_Array);
-    ScanInitsInSubtree(func_name_node, root->right, Variable_Array);
+    WalkStep step = {};
+    while (TreeWalkNext(&walk, &step)) {
+        LangNode_t *node = step.node;
+        if (step.event == kWalkEnter && IsThatOperation(node, kOperationIs) && node->left && node->left->type == kVariable) {
+            RegisterInit(func_name_node, node->left, Variable_Array);
+        }
+    }
+    TreeWalkDtor(&walk);
 }
 
 static void SkipSpaces(const char *buf, size_t *pos) {
@@ -294,6 +354,28 @@ static LangErrors ParseTitle(const char *buffer, size_t *pos, char **out_title)
     return kSuccess;
 }
 
+// An optional "line:col" may follow the title.
+static LangErrors ParseLocation(const char *buffer, size_t *pos, LangNode_t *node, LocationTable *locations) {
+    assert(buffer);
+    assert(pos);
+    assert(node);
+    assert(locations);
+
+    if (!isdigit((unsigned char)buffer[*pos])) {
+        return kSuccess;
+    }
+
+    char *end = NULL;
+    size_t line = strtoul(buffer + *pos, &end, 10);
+    if (*end != ':' || !isdigit((unsigned char)end[1])) {
+        return PrintSyntaxErrorNode((size_t)(end - buffer), *end);
+    }
+    size_t col = strtoul(end + 1, &end, 10);
+    *pos = (size_t)(end - buffer);
+
+    return AddLocation(locations, line, col, &node->loc);
+}
+
 static LangErrors ExpectClosingParen(const char *buffer, size_t *pos) {
     assert(buffer);
     assert(pos);
@@ -306,4 +388,19 @@ static LangErrors ExpectClosingParen(const char *buffer, size_t *pos) {
     (*pos)++;
 
     return kSuccess;
+}
+
+// Children of a block are read until its ')', every one gets an empty slot to be read into.
+static LangErrors ExpectBlockItem(const char *buffer, size_t *pos, LangNode_t *block) {
+    assert(buffer);
+    assert(pos);
+    assert(block);
+
+    SkipSpaces(buffer, pos);
+
+    if (buffer[*pos] == ')' || buffer[*pos] == '\0') {
+        return kSuccess;
+    }
+
+    return BlockAppend(block, NULL);
 }
\ No newline at end of file
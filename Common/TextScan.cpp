@@ -0,0 +1,175 @@
+#include "Common/TextScan.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+// Scanners stop at `end` and never read past it, so the buffer needs no padding.
+// `newlines` and `line_start` are optional: every '\n' passed over is added to
+// *newlines and *line_start is moved to the byte after the last one.
+
+#if defined(__AVX2__)
+
+#define SCAN_WIDTH 32
+typedef __m256i ScanVector;
+
+static inline ScanVector LoadVector(const char *ptr) {
+    return _mm256_loadu_si256((const __m256i *)ptr);
+}
+
+static inline uint32_t EqualMask(ScanVector vec, char c) {
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(vec, _mm256_set1_epi8(c)));
+}
+
+static inline uint32_t BlankMask(ScanVector vec) {
+    ScanVector shifted = _mm256_sub_epi8(vec, _mm256_set1_epi8('\t'));
+    ScanVector is_ctrl = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8('\r' - '\t')), shifted);
+    ScanVector is_space = _mm256_cmpeq_epi8(vec, _mm256_set1_epi8(' '));
+
+    return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(is_ctrl, is_space));
+}
+
+#elif defined(__SSE2__)
+
+#define SCAN_WIDTH 16
+typedef __m128i ScanVector;
+
+static inline ScanVector LoadVector(const char *ptr) {
+    return _mm_loadu_si128((const __m128i *)ptr);
+}
+
+static inline uint32_t EqualMask(ScanVector vec, char c) {
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(vec, _mm_set1_epi8(c)));
+}
+
+static inline uint32_t BlankMask(ScanVector vec) {
+    ScanVector shifted = _mm_sub_epi8(vec, _mm_set1_epi8('\t'));
+    ScanVector is_ctrl = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+    ScanVector is_space = _mm_cmpeq_epi8(vec, _mm_set1_epi8(' '));
+
+    return (uint32_t)_mm_movemask_epi8(_mm_or_si128(is_ctrl, is_space));
+}
+
+#endif
+
+#ifdef SCAN_WIDTH
+#define SCAN_FULL_MASK ((uint32_t)(((uint64_t)1 << SCAN_WIDTH) - 1))
+
+static inline void CountMaskNewlines(uint32_t nl_mask, const char *block, size_t *newlines, const char **line_start) {
+    if (!nl_mask) {
+        return;
+    }
+
+    if (newlines) {
+        *newlines += (size_t)__builtin_popcount(nl_mask);
+    }
+    if (line_start) {
+        *line_start = block + (31 - __builtin_clz(nl_mask)) + 1;
+    }
+}
+#endif
+
+static inline bool IsBlank(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline void CountNewline(const char *ptr, size_t *newlines, const char **line_start) {
+    if (newlines) {
+        (*newlines)++;
+    }
+    if (line_start) {
+        *line_start = ptr + 1;
+    }
+}
+
+const char *SkipBlanks(const char *ptr, const char *end, size_t *newlines, const char **line_start) {
+    assert(ptr);
+    assert(end);
+
+#ifdef SCAN_WIDTH
+    while (ptr + SCAN_WIDTH <= end) {
+        ScanVector vec = LoadVector(ptr);
+        uint32_t significant = ~BlankMask(vec) & SCAN_FULL_MASK;
+        uint32_t nl_mask = EqualMask(vec, '\n');
+
+        if (significant) {
+            int first = __builtin_ctz(significant);
+            CountMaskNewlines(nl_mask & ((1u << first) - 1), ptr, newlines, line_start);
+            return ptr + first;
+        }
+
+        CountMaskNewlines(nl_mask, ptr, newlines, line_start);
+        ptr += SCAN_WIDTH;
+    }
+#endif
+
+    while (ptr < end && IsBlank(*ptr)) {
+        if (*ptr == '\n') {
+            CountNewline(ptr, newlines, line_start);
+        }
+        ptr++;
+    }
+
+    return ptr;
+}
+
+const char *SkipToLineEnd(const char *ptr, const char *end) {
+    assert(ptr);
+    assert(end);
+
+#ifdef SCAN_WIDTH
+    while (ptr + SCAN_WIDTH <= end) {
+        uint32_t nl_mask = EqualMask(LoadVector(ptr), '\n');
+        if (nl_mask) {
+            return ptr + __builtin_ctz(nl_mask);
+        }
+        ptr += SCAN_WIDTH;
+    }
+#endif
+
+    while (ptr < end && *ptr != '\n') {
+        ptr++;
+    }
+
+    return ptr;
+}
+
+const char *SkipBlockComment(const char *ptr, const char *end, size_t *newlines, const char **line_start) {
+    assert(ptr);
+    assert(end);
+
+#ifdef SCAN_WIDTH
+    while (ptr + SCAN_WIDTH + 1 <= end) {
+        ScanVector vec = LoadVector(ptr);
+        uint32_t closing = EqualMask(vec, '*') & EqualMask(LoadVector(ptr + 1), '/');
+        uint32_t nl_mask = EqualMask(vec, '\n');
+
+        if (closing) {
+            int first = __builtin_ctz(closing);
+            CountMaskNewlines(nl_mask & ((1u << first) - 1), ptr, newlines, line_start);
+            return ptr + first + 2;
+        }
+
+        CountMaskNewlines(nl_mask, ptr, newlines, line_start);
+        ptr += SCAN_WIDTH;
+    }
+#endif
+
+    while (ptr < end) {
+        if (ptr[0] == '*' && ptr + 1 < end && ptr[1] == '/') {
+            return ptr + 2;
+        }
+        if (*ptr == '\n') {
+            CountNewline(ptr, newlines, line_start);
+        }
+        ptr++;
+    }
+
+    return ptr;
+}
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "Common/TokenFunctions.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+static LangErrors TokenBufferRealloc(TokenBuffer *tokens, size_t new_capacity);
+
+LangErrors TokenBufferCtor(TokenBuffer *tokens, size_t capacity) {
+    assert(tokens);
+
+    tokens->type     = NULL;
+    tokens->value    = NULL;
+    tokens->offset   = NULL;
+    tokens->size     = 0;
+    tokens->capacity = 0;
+
+    if (capacity == 0) {
+        capacity = 16;
+    }
+
+    return TokenBufferRealloc(tokens, capacity);
+}
+
+LangErrors TokenBufferPush(TokenBuffer *tokens, NodeTypes type, Value value, size_t offset) {
+    assert(tokens);
+
+    if (tokens->size == tokens->capacity) {
+        LangErrors err = TokenBufferRealloc(tokens, tokens->capacity * 2);
+        if (err != kSuccess) {
+            return err;
+        }
+    }
+
+    if (offset > UINT32_MAX) {
+        fprintf(stderr, "Source offset %zu does not fit into the token buffer.\n", offset);
+        return kFailure;
+    }
+
+    tokens->type[tokens->size]   = (unsigned char)type;
+    tokens->value[tokens->size]  = value;
+    tokens->offset[tokens->size] = (uint32_t)offset;
+    tokens->size++;
+
+    return kSuccess;
+}
+
+LangErrors TokenBufferReserve(TokenBuffer *tokens, size_t capacity) {
+    assert(tokens);
+
+    if (capacity <= tokens->capacity) {
+        return kSuccess;
+    }
+
+    return TokenBufferRealloc(tokens, capacity);
+}
+
+LangErrors TokenBufferSplice(TokenBuffer *tokens, size_t from, size_t to, const TokenBuffer *insert) {
+    assert(tokens);
+    assert(insert);
+    assert(from <= to && to <= tokens->size);
+
+    size_t new_size = tokens->size - (to - from) + insert->size;
+    LangErrors err = TokenBufferReserve(tokens, new_size);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    size_t tail = tokens->size - to;
+    size_t dest = from + insert->size;
+    memmove(tokens->type   + dest, tokens->type   + to, tail * sizeof(unsigned char));
+    memmove(tokens->value  + dest, tokens->value  + to, tail * sizeof(Value));
+    memmove(tokens->offset + dest, tokens->offset + to, tail * sizeof(uint32_t));
+
+    memcpy(tokens->type   + from, insert->type,   insert->size * sizeof(unsigned char));
+    memcpy(tokens->value  + from, insert->value,  insert->size * sizeof(Value));
+    memcpy(tokens->offset + from, insert->offset, insert->size * sizeof(uint32_t));
+
+    tokens->size = new_size;
+    return kSuccess;
+}
+
+LangErrors TokenBufferDtor(TokenBuffer *tokens) {
+    if (!tokens) {
+        return kSuccess;
+    }
+
+    free(tokens->type);
+    free(tokens->value);
+    free(tokens->offset);
+
+    tokens->type     = NULL;
+    tokens->value    = NULL;
+    tokens->offset   = NULL;
+    tokens->size     = 0;
+    tokens->capacity = 0;
+
+    return kSuccess;
+}
+
+void TokenBufferClear(TokenBuffer *tokens) {
+    assert(tokens);
+
+    tokens->size = 0;
+}
+
+bool IsTokenType(const TokenBuffer *tokens, size_t pos, NodeTypes type) {
+    assert(tokens);
+
+    return pos < tokens->size && tokens->type[pos] == type;
+}
+
+bool IsTokenOperation(const TokenBuffer *tokens, size_t pos, OperationTypes type) {
+    assert(tokens);
+
+    return IsTokenType(tokens, pos, kOperation) && tokens->value[pos].operation == type;
+}
+
+static LangErrors TokenBufferRealloc(TokenBuffer *tokens, size_t new_capacity) {
+    assert(tokens);
+
+    unsigned char *new_type = (unsigned char *) realloc (tokens->type, new_capacity * sizeof(unsigned char));
+    if (!new_type) {
+        return kNoMemory;
+    }
+    tokens->type = new_type;
+
+    Value *new_value = (Value *) realloc (tokens->value, new_capacity * sizeof(Value));
+    if (!new_value) {
+        return kNoMemory;
+    }
+    tokens->value = new_value;
+
+    uint32_t *new_offset = (uint32_t *) realloc (tokens->offset, new_capacity * sizeof(uint32_t));
+    if (!new_offset) {
+        return kNoMemory;
+    }
+    tokens->offset = new_offset;
+
+    tokens->capacity = new_capacity;
+    return kSuccess;
+}
\ No newline at end of file
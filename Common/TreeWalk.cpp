@@ -0,0 +1,217 @@
+#include "Common/TreeWalk.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+// Depth-first walk over a heap stack of frames, so tree depth costs memory, not call stack.
+// Every node is reported on entry, between its children and on leaving. A node is read
+// from its slot only after the entry step, so a handler may hang a new node there (the
+// tree reader builds the tree that way) or replace it on leaving. An empty slot gets an
+// entry step with kWalkNil and nothing else. Children of a block are reported in order
+// with a between step after every one but the last; the item count is read again at
+// every step, so a handler may append items to a block it is in.
+
+enum WalkStages : unsigned char {
+    kStageEnter,
+    kStageFirstChild,
+    kStageBetween,
+    kStageSecondChild,
+    kStageItem,
+    kStageItemBetween,
+    kStageLeave,
+};
+
+static bool TreeWalkPush(TreeWalk *walk, LangNode_t **link, LangNode_t *parent, size_t depth);
+static bool TreeWalkPushChild(TreeWalk *walk, const WalkFrame *frame, bool first);
+static bool TreeWalkPushItem(TreeWalk *walk, WalkFrame *frame);
+static void TreeWalkReport(const WalkFrame *frame, WalkEvents event, WalkStep *step);
+
+LangErrors TreeWalkCtor(TreeWalk *walk, LangNode_t **root, unsigned flags) {
+    assert(walk);
+    assert(root);
+
+    walk->frames   = NULL;
+    walk->size     = 0;
+    walk->capacity = 0;
+    walk->flags    = flags;
+    walk->error    = kSuccess;
+
+    if (!*root && !(flags & kWalkNil)) {
+        return kSuccess;
+    }
+
+    TreeWalkPush(walk, root, NULL, 0);
+    return walk->error;
+}
+
+void TreeWalkDtor(TreeWalk *walk) {
+    if (!walk) {
+        return;
+    }
+
+    free(walk->frames);
+    walk->frames   = NULL;
+    walk->size     = 0;
+    walk->capacity = 0;
+}
+
+bool TreeWalkNext(TreeWalk *walk, WalkStep *step) {
+    assert(walk);
+    assert(step);
+
+    while (walk->size > 0) {
+        WalkFrame *frame = &walk->frames[walk->size - 1];
+
+        switch ((WalkStages)frame->stage) {
+            case kStageEnter:
+                frame->stage = kStageFirstChild;
+                TreeWalkReport(frame, kWalkEnter, step);
+                return true;
+
+            case kStageFirstChild:
+                if (!*frame->link) {
+                    walk->size--;
+                    break;
+                }
+                if ((*frame->link)->type == kBlock) {
+                    frame->stage = kStageItem;
+                    break;
+                }
+                frame->stage = kStageBetween;
+                if (!TreeWalkPushChild(walk, frame, true)) {
+                    return false;
+                }
+                break;
+
+            case kStageBetween:
+                frame->stage = kStageSecondChild;
+                TreeWalkReport(frame, kWalkBetween, step);
+                return true;
+
+            case kStageSecondChild:
+                frame->stage = kStageLeave;
+                if (!TreeWalkPushChild(walk, frame, false)) {
+                    return false;
+                }
+                break;
+
+            case kStageItem:
+                if (frame->index >= (*frame->link)->value.block->size) {
+                    frame->stage = kStageLeave;
+                    break;
+                }
+                frame->stage = kStageItemBetween;
+                if (!TreeWalkPushItem(walk, frame)) {
+                    return false;
+                }
+                break;
+
+            case kStageItemBetween:
+                if (frame->index >= (*frame->link)->value.block->size) {
+                    frame->stage = kStageLeave;
+                    break;
+                }
+                frame->stage = kStageItem;
+                TreeWalkReport(frame, kWalkBetween, step);
+                return true;
+
+            case kStageLeave:
+                TreeWalkReport(frame, kWalkLeave, step);
+                walk->size--;
+                return true;
+
+            default:
+                assert(0 && "Unknown tree walk stage");
+                return false;
+        }
+    }
+
+    return false;
+}
+
+// Called right after the entry step: the children are not visited, the leave step still comes.
+void TreeWalkSkip(TreeWalk *walk) {
+    assert(walk);
+    assert(walk->size > 0);
+    assert(walk->frames[walk->size - 1].stage == kStageFirstChild);
+
+    if (*walk->frames[walk->size - 1].link) {
+        walk->frames[walk->size - 1].stage = kStageLeave;
+    }
+}
+
+static void TreeWalkReport(const WalkFrame *frame, WalkEvents event, WalkStep *step) {
+    assert(frame);
+    assert(step);
+
+    step->event  = event;
+    step->node   = *frame->link;
+    step->link   = frame->link;
+    step->parent = frame->parent;
+    step->depth  = frame->depth;
+}
+
+static bool TreeWalkPushChild(TreeWalk *walk, const WalkFrame *frame, bool first) {
+    assert(walk);
+    assert(frame);
+
+    LangNode_t *node = *frame->link;
+    bool left = (first != ((walk->flags & kWalkRightFirst) != 0));
+    LangNode_t **child = left ? &node->left : &node->right;
+
+    if (!*child && !(walk->flags & kWalkNil)) {
+        return true;
+    }
+
+    return TreeWalkPush(walk, child, node, frame->depth + 1);
+}
+
+// Takes the frame's next item, from the back with kWalkRightFirst. Pushing may move the
+// frames, so the frame is not touched afterwards.
+static bool TreeWalkPushItem(TreeWalk *walk, WalkFrame *frame) {
+    assert(walk);
+    assert(frame);
+
+    LangNode_t *node = *frame->link;
+    NodeList *list = node->value.block;
+    size_t i = (walk->flags & kWalkRightFirst) ? list->size - 1 - frame->index : frame->index;
+    frame->index++;
+
+    if (!list->items[i] && !(walk->flags & kWalkNil)) {
+        return true;
+    }
+
+    return TreeWalkPush(walk, &list->items[i], node, frame->depth + 1);
+}
+
+static bool TreeWalkPush(TreeWalk *walk, LangNode_t **link, LangNode_t *parent, size_t depth) {
+    assert(walk);
+    assert(link);
+
+    if (walk->size == walk->capacity) {
+        size_t new_capacity = walk->capacity ? walk->capacity * 2 : 64;
+        WalkFrame *new_frames = (WalkFrame *) realloc (walk->frames, new_capacity * sizeof(WalkFrame));
+        if (!new_frames) {
+            fprintf(stderr, "No memory to walk the tree.\n");
+            walk->error = kNoMemory;
+            walk->size  = 0;
+            return false;
+        }
+
+        walk->frames   = new_frames;
+        walk->capacity = new_capacity;
+    }
+
+    WalkFrame *frame = &walk->frames[walk->size++];
+    frame->link   = link;
+    frame->parent = parent;
+    frame->depth  = depth;
+    frame->index  = 0;
+    frame->stage  = kStageEnter;
+
+    return true;
+}
\ No newline at end of file
@@ -3,52 +3,66 @@
 #include <stdio.h>
 #include <assert.h>
 #include <string.h>
-#include <ctype.h>
 #include <stdlib.h>
 
 #include "Common/Enums.h"
 #include "Common/Structs.h"
-#include "Common/StackFunctions.h"
 #include "Common/LanguageFunctions.h"
-
-typedef enum {
-    kStateStart,
-    kStateNumber,
-    kStateIdentifier,
-} LexerState;
+#include "Common/TokenFunctions.h"
+#include "Common/TextScan.h"
+#include "Common/Numbers.h"
+#include "Front-End/KeywordDfa.h"
 
 typedef struct {
     const char *src;
+    size_t len;
     size_t pos;
     size_t line;
     size_t col;
     size_t token_start;
-    LexerState state;
+
+    FILE *file;
+    char *window;
+    size_t capacity;
+    size_t chunk_size;
+    size_t base;
+    bool eof;
+    bool split_functions;
 } Lexer;
 
-#define kContinue 2
+struct FsmStream {
+    Lexer lexer;
+};
+
+#define kBoundary 3
 
-#define NEWN(num) NewNode(lang_info, kNumber, (Value){.number = (num)}, NULL, NULL)
-#define NEWV(name) NewVariable(lang_info, name)
-#define NEWOP(op)  NewNode(lang_info, kOperation, (Value){.operation = (op)}, NULL, NULL)
+#define PUSH_TOKEN(type, val) TokenBufferPush(lang_info->token_buf, (type), (val), lexer->base + lexer->token_start)
 
-static void InitLexer(Lexer *lexer, const char *src);
-static inline char Peek(const Lexer *lexer);
-static inline char PeekNext(const Lexer *lexer);
+static constexpr KeywordDfa KEYWORD_DFA = BuildKeywordDfa(NAME_TYPES_TABLE, OP_TABLE_SIZE);
+
+static_assert(KeywordDfaMatch(KEYWORD_DFA, NAME_TYPES_TABLE[kOperationFunction].name_in_lang) == kOperationFunction,
+              "Lexer DFA does not recognise the keywords it was built from.");
+
+static void InitLexer(Lexer *lexer, const char *src, size_t len);
+static bool Refill(Lexer *lexer, size_t need);
+static inline bool EnsureAvailable(Lexer *lexer, size_t count);
+static inline char Peek(Lexer *lexer);
+static inline char PeekNext(Lexer *lexer);
 static inline char Advance(Lexer *lexer);
-static inline int CheckEnd(const Lexer *lexer);
-static inline int IsWordChar(char c);
+static inline int CheckEnd(Lexer *lexer);
+static void AdvanceTo(Lexer *lexer, const char *next, size_t newlines, const char *line_start);
 static void SkipWhitespaceAndComments(Lexer *lexer);
-static OperationTypes FindOperator(const Lexer *lexer, size_t *matched_size);
+static void SkipLineComment(Lexer *lexer);
+static void SkipBlockCommentBody(Lexer *lexer);
 static int ParseToken(Lexer *lexer, Language *lang_info, size_t *cnt);
 
-static int ProcessLexerState(Lexer *lexer, Language *lang_info, size_t *cnt);
-static int HandleStartState(Lexer *lexer, Language *lang_info, size_t *cnt);
+static int ScanToken(Lexer *lexer, Language *lang_info, size_t *cnt);
 static int HandleOperator(Lexer *lexer, Language *lang_info, size_t *cnt, OperationTypes op, size_t op_len);
-static int HandleNumberState(Lexer *lexer, Language *lang_info, size_t *cnt);
-static int FinishNumberToken(Lexer *lexer, Language *lang_info, size_t *cnt);
-static int HandleIdentifierState(Lexer *lexer, Language *lang_info, size_t *cnt);
-static int FinishIdentifierToken(Lexer *lexer, Language *lang_info, size_t *cnt);
+static int FinishNumberToken(Lexer *lexer, Language *lang_info, size_t *cnt, size_t len);
+static size_t ScanNumberTail(Lexer *lexer, size_t len);
+static size_t SkipDigitsAt(Lexer *lexer, size_t len);
+static inline char PeekAt(Lexer *lexer, size_t offset);
+static int FinishIdentifierToken(Lexer *lexer, Language *lang_info, size_t *cnt, size_t len);
 
 // static void DumpToken(const Language *lang_info, const LangNode_t *node, size_t i);
 // void DumpAllTokens(const Language *lang_info) {
@@ -102,8 +116,18 @@ size_t CheckAndReturn_fsm(Language *lang_info, const char **string) {
     assert(lang_info);
     assert(string);
 
+    return CheckAndReturnRange_fsm(lang_info, string, *string + strlen(*string));
+}
+
+// As with CheckAndReturnRange, a token that starts before `end` is read to its end.
+size_t CheckAndReturnRange_fsm(Language *lang_info, const char **string, const char *end) {
+    assert(lang_info);
+    assert(lang_info->token_buf);
+    assert(string);
+    assert(end);
+
     Lexer lexer = {};
-    InitLexer(&lexer, *string);
+    InitLexer(&lexer, *string, (size_t)(end - *string));
 
     size_t cnt = 0;
 
@@ -112,37 +136,157 @@ size_t CheckAndReturn_fsm(Language *lang_info, const char **string) {
         continue;
     }
 
-    
     if (result < 0) {
         fprintf(stderr, "Lexer error\n");
+        *string = lexer.src + lexer.token_start;
+        return 0;
     }
-    
+
     *string = lexer.src + lexer.pos;
-    lang_info->tokens->la_size = cnt;
     return cnt;
 }
 
-static void InitLexer(Lexer *lexer, const char *src) {
+LangErrors FsmStreamCtor(FsmStream **stream, FILE *file, size_t chunk_size) {
+    assert(stream);
+    assert(file);
+
+    if (chunk_size == 0) {
+        chunk_size = FSM_STREAM_CHUNK_SIZE;
+    }
+
+    *stream = (FsmStream *) calloc (1, sizeof(FsmStream));
+    if (!*stream) {
+        return kNoMemory;
+    }
+
+    Lexer *lexer = &(*stream)->lexer;
+    lexer->window = (char *) calloc (chunk_size + 1, sizeof(char));
+    if (!lexer->window) {
+        free(*stream);
+        *stream = NULL;
+        return kNoMemory;
+    }
+
+    InitLexer(lexer, lexer->window, 0);
+    lexer->file            = file;
+    lexer->capacity        = chunk_size;
+    lexer->chunk_size      = chunk_size;
+    lexer->split_functions = true;
+
+    return kSuccess;
+}
+
+void FsmStreamDtor(FsmStream *stream) {
+    if (!stream) {
+        return;
+    }
+
+    free(stream->lexer.window);
+    free(stream);
+}
+
+LangErrors CheckAndReturnFunction_fsm(Language *lang_info, FsmStream *stream, size_t *cnt) {
+    assert(lang_info);
+    assert(lang_info->token_buf);
+    assert(stream);
+    assert(cnt);
+
+    *cnt = 0;
+
+    int result = 0;
+    while ((result = ParseToken(&stream->lexer, lang_info, cnt)) > 0) {
+        continue;
+    }
+
+    if (result < 0) {
+        fprintf(stderr, "Lexer error\n");
+        return kFailure;
+    }
+
+    return kSuccess;
+}
+
+static void InitLexer(Lexer *lexer, const char *src, size_t len) {
     assert(lexer);
     assert(src);
 
     lexer->src = src;
+    lexer->len = len;
     lexer->pos = 0;
     lexer->line = 1;
     lexer->col = 1;
-    lexer->state = kStateStart;
     lexer->token_start = 0;
 }
 
-static inline char Peek(const Lexer *lexer) {
+// Drops everything before the current token, then reads at least `need`
+// more bytes. Only stream lexers have a file to read from.
+static bool Refill(Lexer *lexer, size_t need) {
     assert(lexer);
 
+    if (!lexer->file || lexer->eof) {
+        return false;
+    }
+
+    size_t keep = (lexer->token_start < lexer->pos) ? lexer->token_start : lexer->pos;
+    memmove(lexer->window, lexer->window + keep, lexer->len - keep);
+    lexer->base        += keep;
+    lexer->len         -= keep;
+    lexer->pos         -= keep;
+    lexer->token_start -= keep;
+
+    size_t want = (need > lexer->chunk_size) ? need : lexer->chunk_size;
+    if (lexer->capacity - lexer->len < want) {
+        char *new_window = (char *) realloc (lexer->window, lexer->len + want + 1);
+        if (!new_window) {
+            fprintf(stderr, "Memory allocation failed for lexer window.\n");
+            lexer->eof = true;
+            return false;
+        }
+        lexer->window   = new_window;
+        lexer->capacity = lexer->len + want;
+    }
+
+    size_t got = fread(lexer->window + lexer->len, 1, lexer->capacity - lexer->len, lexer->file);
+    if (got == 0) {
+        lexer->eof = true;
+    }
+
+    lexer->len += got;
+    lexer->window[lexer->len] = '\0';
+    lexer->src = lexer->window;
+
+    return got > 0;
+}
+
+static inline bool EnsureAvailable(Lexer *lexer, size_t count) {
+    assert(lexer);
+
+    while (lexer->len - lexer->pos < count) {
+        if (!Refill(lexer, count)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static inline char Peek(Lexer *lexer) {
+    assert(lexer);
+
+    if (lexer->pos >= lexer->len && !EnsureAvailable(lexer, 1)) {
+        return '\0';
+    }
+
     return lexer->src[lexer->pos];
 }
 
-static inline char PeekNext(const Lexer *lexer) {
+static inline char PeekNext(Lexer *lexer) {
     assert(lexer);
 
+    if (lexer->len - lexer->pos < 2 && !EnsureAvailable(lexer, 2)) {
+        return (lexer->pos < lexer->len) ? lexer->src[lexer->pos + 1] : '\0';
+    }
+
     return lexer->src[lexer->pos + 1];
 }
 
@@ -160,45 +304,56 @@ static inline char Advance(Lexer *lexer) {
     return c;
 }
 
-static inline int CheckEnd(const Lexer *lexer) {
+static inline int CheckEnd(Lexer *lexer) {
     assert(lexer);
 
     return Peek(lexer) == '\0';
 }
 
-static inline int IsWordChar(char c) {
-    return isalnum((unsigned char)c) || c == '_';
+static void AdvanceTo(Lexer *lexer, const char *next, size_t newlines, const char *line_start) {
+    assert(lexer);
+    assert(next);
+
+    size_t next_pos = (size_t)(next - lexer->src);
+
+    if (newlines) {
+        assert(line_start);
+        lexer->line += newlines;
+        lexer->col = (size_t)(next - line_start) + 1;
+    } else {
+        lexer->col += next_pos - lexer->pos;
+    }
+
+    lexer->pos = next_pos;
 }
 
 static void SkipWhitespaceAndComments(Lexer *lexer) {
     assert(lexer);
 
     while (true) {
-        char c = Peek(lexer);
+        do {
+            size_t newlines = 0;
+            const char *line_start = NULL;
 
-        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
-            Advance(lexer);
-            continue;
+            lexer->token_start = lexer->pos;
+            const char *next = SkipBlanks(lexer->src + lexer->pos, lexer->src + lexer->len, &newlines, &line_start);
+            AdvanceTo(lexer, next, newlines, line_start);
+        } while (lexer->pos == lexer->len && Refill(lexer, 1));
+
+        if (Peek(lexer) != '/') {
+            break;
         }
 
-        if (c == '/' && PeekNext(lexer) == '/') {
-            while (!CheckEnd(lexer) && Peek(lexer) != '\n') {
-                Advance(lexer);
-            }
+        char next_char = PeekNext(lexer);
+        if (next_char == '/') {
+            AdvanceTo(lexer, lexer->src + lexer->pos + 2, 0, NULL);
+            SkipLineComment(lexer);
             continue;
         }
 
-        if (c == '/' && PeekNext(lexer) == '*') {
-            Advance(lexer);
-            Advance(lexer);
-            while (!CheckEnd(lexer)) {
-                if (Peek(lexer) == '*' && PeekNext(lexer) == '/') {
-                    Advance(lexer);
-                    Advance(lexer);
-                    break;
-                }
-                Advance(lexer);
-            }
+        if (next_char == '*') {
+            AdvanceTo(lexer, lexer->src + lexer->pos + 2, 0, NULL);
+            SkipBlockCommentBody(lexer);
             continue;
         }
 
@@ -206,43 +361,43 @@ static void SkipWhitespaceAndComments(Lexer *lexer) {
     }
 }
 
-static OperationTypes FindOperator(const Lexer *lexer, size_t *matched_size) {
+static void SkipLineComment(Lexer *lexer) {
     assert(lexer);
-    assert(matched_size);
 
-    OperationTypes result = kOperationNone;
-    size_t best_size = 0;
-    const char *src = lexer->src + lexer->pos;
+    do {
+        lexer->token_start = lexer->pos;
+        const char *next = SkipToLineEnd(lexer->src + lexer->pos, lexer->src + lexer->len);
+        AdvanceTo(lexer, next, 0, NULL);
+    } while (lexer->pos == lexer->len && Refill(lexer, 1));
+}
 
-    for (size_t i = 0; i < OP_TABLE_SIZE; i++) {
-        const char *name = NAME_TYPES_TABLE[i].name_in_lang;
-        if (!name || !name[0]) {
-            continue;
-        }
+static void SkipBlockCommentBody(Lexer *lexer) {
+    assert(lexer);
 
-        size_t size = strlen(name);
-        if (strncmp(src, name, size) != 0) {
-            continue;
-        }
+    while (true) {
+        size_t newlines = 0;
+        const char *line_start = NULL;
 
-        if (isalpha((unsigned char)name[0])) {
-            char next = src[size];
-            if (IsWordChar(next)) {
-                continue;
-            }
+        lexer->token_start = lexer->pos;
+        const char *start = lexer->src + lexer->pos;
+        const char *end   = lexer->src + lexer->len;
+        const char *next  = SkipBlockComment(start, end, &newlines, &line_start);
+
+        bool closed = next < end || (next - start >= 2 && next[-2] == '*' && next[-1] == '/');
+        if (!closed && next > start && next[-1] == '*') {
+            next--; // "*/" may straddle the window edge
         }
 
-        if (size > best_size) {
-            best_size = size;
-            result = NAME_TYPES_TABLE[i].type;
+        AdvanceTo(lexer, next, newlines, line_start);
+        if (closed) {
+            return;
         }
-    }
 
-    if (result != kOperationNone) {
-        *matched_size = best_size;
+        if (!Refill(lexer, 2)) {
+            AdvanceTo(lexer, lexer->src + lexer->len, 0, NULL);
+            return;
+        }
     }
-
-    return result;
 }
 
 static int ParseToken(Lexer *lexer, Language *lang_info, size_t *cnt) {
@@ -257,81 +412,64 @@ static int ParseToken(Lexer *lexer, Language *lang_info, size_t *cnt) {
     }
 
     lexer->token_start = lexer->pos;
-    lexer->state = kStateStart;
 
-    while (true) {
-        int res = ProcessLexerState(lexer, lang_info, cnt);
-
-        if (res == kContinue) {
-            continue;
-        }
-
-        if (res == kFailure) {
-            return -1;
-        }
+    int res = ScanToken(lexer, lang_info, cnt);
+    if (res == kFailure) {
+        return -1;
+    }
 
-        return 1;
+    if (res == kBoundary) {
+        return 0;
     }
+
+    return 1;
 }
 
-static int ProcessLexerState(Lexer *lexer, Language *lang_info, size_t *cnt) {
+// Runs the DFA as far as it goes and takes the longest accepted prefix.
+static int ScanToken(Lexer *lexer, Language *lang_info, size_t *cnt) {
     assert(lexer);
     assert(lang_info);
     assert(cnt);
 
+    size_t state = DFA_START_STATE;
+    size_t len = 0;
+    size_t accept_len = 0;
+    size_t accept_state = DFA_DEAD_STATE;
+
     while (true) {
-        switch (lexer->state) {
-            case kStateStart:
-                return HandleStartState(lexer, lang_info, cnt);
-                
-            case kStateNumber:
-                return HandleNumberState(lexer, lang_info, cnt);
-                
-            case kStateIdentifier:
-                return HandleIdentifierState(lexer, lang_info, cnt);
-                
-            default:
-                fprintf(stderr, "Unknown lexer state: %d.\n", lexer->state);
-                return kFailure;
+        size_t next = KEYWORD_DFA.next[state][KEYWORD_DFA.byte_class[(unsigned char)lexer->src[lexer->pos + len]]];
+        if (next == DFA_DEAD_STATE) {
+            // The window ends with '\0', which no token accepts, so only then look for more input.
+            if (lexer->pos + len >= lexer->len && EnsureAvailable(lexer, len + 1)) {
+                continue;
+            }
+            break;
+        }
+
+        state = next;
+        len++;
+        if (KEYWORD_DFA.accept[state] != kDfaReject) {
+            accept_len = len;
+            accept_state = state;
         }
     }
-}
 
-static int HandleStartState(Lexer *lexer, Language *lang_info, size_t *cnt) {
-    assert(lexer);
-    assert(lang_info);
-    assert(cnt);
+    switch (KEYWORD_DFA.accept[accept_state]) {
+        case kDfaKeyword:
+            return HandleOperator(lexer, lang_info, cnt, (OperationTypes)KEYWORD_DFA.keyword[accept_state], accept_len);
 
-    char c = Peek(lexer);
-    
-    if (c == '-' && isdigit((unsigned char)lexer->src[lexer->pos + 1])) {
-        lexer->state = kStateNumber;
-        Advance(lexer);
-        Advance(lexer);
-        return kContinue;
-    }
-    
-    size_t op_len = 0;
-    OperationTypes op = FindOperator(lexer, &op_len);
-    if (op != kOperationNone) {
-        return HandleOperator(lexer, lang_info, cnt, op, op_len);
-    }
-    
-    if (isdigit((unsigned char)c)) {
-        lexer->state = kStateNumber;
-        Advance(lexer);
-        return kContinue;
-    }
-    
-    if (isalpha((unsigned char)c) || c == '_') {
-        lexer->state = kStateIdentifier;
-        Advance(lexer);
-        return kContinue;
+        case kDfaNumber:
+            return FinishNumberToken(lexer, lang_info, cnt, ScanNumberTail(lexer, accept_len));
+
+        case kDfaIdentifier:
+            return FinishIdentifierToken(lexer, lang_info, cnt, accept_len);
+
+        case kDfaReject:
+        default:
+            fprintf(stderr, "Lexer error [%zu:%zu]: '%c'.\n", lexer->line, lexer->col, Peek(lexer));
+            Advance(lexer);
+            return kFailure;
     }
-    
-    fprintf(stderr, "Lexer error [%zu:%zu]: '%c'.\n", lexer->line, lexer->col, c);
-    Advance(lexer);
-    return kFailure;
 }
 
 static int HandleOperator(Lexer *lexer, Language *lang_info, size_t *cnt, OperationTypes op, size_t op_len) {
@@ -339,9 +477,12 @@ static int HandleOperator(Lexer *lexer, Language *lang_info, size_t *cnt, Operat
     assert(lang_info);
     assert(cnt);
 
-    LangNode_t *node = NEWOP(op);
-    if (!node) {
-        fprintf(stderr, "Error creating operator node.\n");
+    if (op == kOperationFunction && lexer->split_functions && lang_info->token_buf->size > 0) {
+        return kBoundary;
+    }
+
+    if (PUSH_TOKEN(kOperation, (Value){ .operation = op }) != kSuccess) {
+        fprintf(stderr, "Error pushing operator token.\n");
         return kFailure;
     }
     
@@ -351,85 +492,90 @@ static int HandleOperator(Lexer *lexer, Language *lang_info, size_t *cnt, Operat
     return kSuccess;
 }
 
-static int HandleNumberState(Lexer *lexer, Language *lang_info, size_t *cnt) {
+static int FinishNumberToken(Lexer *lexer, Language *lang_info, size_t *cnt, size_t len) {
     assert(lexer);
     assert(lang_info);
     assert(cnt);
 
-    char c = Peek(lexer);
-    
-    if (isdigit((unsigned char)c)) {
-        Advance(lexer);
-        return kContinue;
-    }
-    
-    return FinishNumberToken(lexer, lang_info, cnt);
-}
+    const char *digits = lexer->src + lexer->token_start;
 
-static int FinishNumberToken(Lexer *lexer, Language *lang_info, size_t *cnt) {
-    assert(lexer);
-    assert(lang_info);
-    assert(cnt);
-
-    size_t len = lexer->pos - lexer->token_start;
-    
-    char *buf = (char *) calloc (len + 1, sizeof(char));
-    if (!buf) {
-        fprintf(stderr, "Memory allocation failed for number buffer.\n");
+    double number = 0;
+    if (!ParseNumber(digits, digits + len, &number)) {
+        fprintf(stderr, "Lexer error [%zu:%zu]: number does not fit into a double.\n", lexer->line, lexer->col);
         return kFailure;
     }
-    
-    strncpy(buf, lexer->src + lexer->token_start, len);
-    
-    int number = atoi(buf);
-    LangNode_t *node = NEWN(number);
-    if (!node) {
-        fprintf(stderr, "Error creating number node.\n");
-        free(buf);
+
+    if (PUSH_TOKEN(kNumber, (Value){ .number = number }) != kSuccess) {
+        fprintf(stderr, "Error pushing number token.\n");
         return kFailure;
     }
-    
-    free(buf);
+
     (*cnt)++;
+    lexer->pos += len;
+    lexer->col += len;
     return kSuccess;
 }
 
-static int HandleIdentifierState(Lexer *lexer, Language *lang_info, size_t *cnt) {
+// The DFA only takes the integer part, the fraction and the exponent are read here,
+// which keeps the transition table small.
+static size_t ScanNumberTail(Lexer *lexer, size_t len) {
     assert(lexer);
-    assert(lang_info);
-    assert(cnt);
 
-    char c = Peek(lexer);
-    
-    if (IsWordChar(c)) {
-        Advance(lexer);
-        return kContinue;
+    if (PeekAt(lexer, len) == '.' && IsDfaDigit((unsigned char)PeekAt(lexer, len + 1))) {
+        len = SkipDigitsAt(lexer, len + 1);
     }
-    
-    return FinishIdentifierToken(lexer, lang_info, cnt);
+
+    char mark = PeekAt(lexer, len);
+    if (mark == 'e' || mark == 'E') {
+        size_t exponent = len + 1;
+        char sign = PeekAt(lexer, exponent);
+        if (sign == '+' || sign == '-') {
+            exponent++;
+        }
+
+        if (IsDfaDigit((unsigned char)PeekAt(lexer, exponent))) {
+            len = SkipDigitsAt(lexer, exponent);
+        }
+    }
+
+    return len;
+}
+
+static size_t SkipDigitsAt(Lexer *lexer, size_t len) {
+    assert(lexer);
+
+    while (IsDfaDigit((unsigned char)PeekAt(lexer, len))) {
+        len++;
+    }
+
+    return len;
+}
+
+// Like the DFA loop, relies on the '\0' behind the window rather than on its length.
+static inline char PeekAt(Lexer *lexer, size_t offset) {
+    assert(lexer);
+
+    if (lexer->pos + offset >= lexer->len) {
+        EnsureAvailable(lexer, offset + 1);
+    }
+
+    return lexer->src[lexer->pos + offset];
 }
 
-static int FinishIdentifierToken(Lexer *lexer, Language *lang_info, size_t *cnt) {
+static int FinishIdentifierToken(Lexer *lexer, Language *lang_info, size_t *cnt, size_t len) {
     assert(lexer);
     assert(lang_info);
     assert(cnt);
 
-    size_t len = lexer->pos - lexer->token_start;
-    
-    char *name = (char *) calloc (len + 1, 1);
-    if (!name) {
-        fprintf(stderr, "Memory allocation failed for identifier name.\n");
-        return kFailure;
-    }
-    
-    strncpy(name, lexer->src + lexer->token_start, len);
-    
-    LangNode_t *node = NEWV(name);
-    if (!node) {
-        fprintf(stderr, "Error creating variable node.\n");
+    size_t var_pos = 0;
+    if (InternVariable(lang_info->arr, lexer->src + lexer->token_start, len, &var_pos) != kSuccess
+            || PUSH_TOKEN(kVariable, (Value){ .pos = var_pos }) != kSuccess) {
+        fprintf(stderr, "Error pushing variable token.\n");
         return kFailure;
     }
     
     (*cnt)++;
+    lexer->pos += len;
+    lexer->col += len;
     return kSuccess;
 }
\ No newline at end of file
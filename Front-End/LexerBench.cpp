@@ -0,0 +1,248 @@
+#include "Front-End/LexerBench.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+#include "Common/CommonFunctions.h"
+#include "Common/LanguageFunctions.h"
+#include "Common/TokenFunctions.h"
+#include "Front-End/LexicalAnalysis.h"
+
+// Both lexers see every file from the same buffer. Each is timed on its best of
+// LEXER_BENCH_RUNS passes, name tables and token buffers are made outside the clock.
+// Variables are compared by name, so the harness does not depend on interning order.
+
+static const char *LEXER_NAMES[] = {"table", "fsm"};
+static const size_t LEXERS_CNT = sizeof(LEXER_NAMES) / sizeof(LEXER_NAMES[0]);
+
+struct LexRun {
+    VariableArr arr;
+    TokenBuffer tokens;
+    size_t stop;    // where the lexer gave up, the file size if it did not
+    double seconds;
+};
+
+static LangErrors LexFile(LexerKinds lexer, const FileInfo *Info, LexRun *run);
+static void LexRunDtor(LexRun *run);
+static bool FindMismatch(const LexRun *expected, const LexRun *got, size_t *pos);
+static bool IsSameToken(const LexRun *expected, const LexRun *got, size_t pos);
+static void PrintToken(FILE *out, const LexRun *run, size_t pos);
+static void PrintPosition(FILE *out, const FileInfo *Info, size_t offset);
+static double Speed(double amount, double seconds);
+static double Seconds(void);
+
+LangErrors CompareLexers(const char *const *files, size_t count, FILE *out) {
+    assert(files);
+    assert(out);
+
+    size_t total_bytes = 0;
+    size_t total_tokens[LEXERS_CNT] = {};
+    double total_seconds[LEXERS_CNT] = {};
+    size_t mismatches = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        FILE_OPEN_AND_CHECK(file, files[i], "r", NULL, NULL);
+
+        FileInfo Info = {};
+        LangErrors err = DoBufRead(file, files[i], &Info);
+        fclose(file);
+        if (err != kSuccess) {
+            return err;
+        }
+
+        LexRun runs[LEXERS_CNT] = {};
+        for (size_t lexer = 0; lexer < LEXERS_CNT && err == kSuccess; lexer++) {
+            err = LexFile((LexerKinds)lexer, &Info, &runs[lexer]);
+        }
+
+        if (err == kSuccess) {
+            fprintf(out, "%s: %zu bytes\n", files[i], Info.filesize);
+            total_bytes += Info.filesize;
+
+            for (size_t lexer = 0; lexer < LEXERS_CNT; lexer++) {
+                fprintf(out, "    %-5s %10zu tokens %10.1f MB/s %10.2f Mtokens/s\n", LEXER_NAMES[lexer], runs[lexer].tokens.size,
+                        Speed((double)Info.filesize / 1e6, runs[lexer].seconds), Speed((double)runs[lexer].tokens.size / 1e6, runs[lexer].seconds));
+
+                total_tokens[lexer]  += runs[lexer].tokens.size;
+                total_seconds[lexer] += runs[lexer].seconds;
+            }
+
+            for (size_t lexer = 1; lexer < LEXERS_CNT; lexer++) {
+                size_t pos = 0;
+                if (!FindMismatch(&runs[0], &runs[lexer], &pos)) {
+                    fprintf(out, "    %s and %s agree\n", LEXER_NAMES[0], LEXER_NAMES[lexer]);
+                    continue;
+                }
+
+                mismatches++;
+                fprintf(out, "    %s and %s differ at token %zu:\n", LEXER_NAMES[0], LEXER_NAMES[lexer], pos);
+                for (size_t side = 0; side < 2; side++) {
+                    const LexRun *run = side ? &runs[lexer] : &runs[0];
+                    fprintf(out, "        %-5s ", LEXER_NAMES[side ? lexer : 0]);
+                    PrintToken(out, run, pos);
+                    PrintPosition(out, &Info, pos < run->tokens.size ? run->tokens.offset[pos] : run->stop);
+                }
+            }
+        }
+
+        for (size_t lexer = 0; lexer < LEXERS_CNT; lexer++) {
+            LexRunDtor(&runs[lexer]);
+        }
+        DoBufFree(&Info);
+
+        if (err != kSuccess) {
+            return err;
+        }
+    }
+
+    fprintf(out, "total: %zu files, %zu bytes, %zu mismatching\n", count, total_bytes, mismatches);
+    for (size_t lexer = 0; lexer < LEXERS_CNT; lexer++) {
+        fprintf(out, "    %-5s %10zu tokens %10.1f MB/s %10.2f Mtokens/s\n", LEXER_NAMES[lexer], total_tokens[lexer],
+                Speed((double)total_bytes / 1e6, total_seconds[lexer]), Speed((double)total_tokens[lexer] / 1e6, total_seconds[lexer]));
+    }
+
+    return mismatches ? kFailure : kSuccess;
+}
+
+static LangErrors LexFile(LexerKinds lexer, const FileInfo *Info, LexRun *run) {
+    assert(Info);
+    assert(run);
+
+    for (size_t i = 0; i < LEXER_BENCH_RUNS; i++) {
+        LexRunDtor(run);
+
+        LangErrors err = InitArrOfVariable(&run->arr, 16);
+        if (err == kSuccess) {
+            err = TokenBufferCtor(&run->tokens, Info->filesize / 4);
+        }
+        if (err != kSuccess) {
+            return err;
+        }
+
+        Language lang_info = {};
+        lang_info.arr       = &run->arr;
+        lang_info.token_buf = &run->tokens;
+        lang_info.lexer     = lexer;
+
+        const char *ptr = Info->buf_ptr;
+        double start = Seconds();
+        LexRange(&lang_info, &ptr, Info->buf_ptr + Info->filesize);
+        double seconds = Seconds() - start;
+
+        if (i == 0 || seconds < run->seconds) {
+            run->seconds = seconds;
+        }
+        run->stop = (size_t)(ptr - Info->buf_ptr);
+    }
+
+    return kSuccess;
+}
+
+static void LexRunDtor(LexRun *run) {
+    assert(run);
+
+    DtorVariableArray(&run->arr);
+    TokenBufferDtor(&run->tokens);
+}
+
+static bool FindMismatch(const LexRun *expected, const LexRun *got, size_t *pos) {
+    assert(expected);
+    assert(got);
+    assert(pos);
+
+    size_t size = expected->tokens.size < got->tokens.size ? expected->tokens.size : got->tokens.size;
+    for (size_t i = 0; i < size; i++) {
+        if (!IsSameToken(expected, got, i)) {
+            *pos = i;
+            return true;
+        }
+    }
+
+    *pos = size;
+    return expected->tokens.size != got->tokens.size || expected->stop != got->stop;
+}
+
+static bool IsSameToken(const LexRun *expected, const LexRun *got, size_t pos) {
+    assert(expected);
+    assert(got);
+
+    const TokenBuffer *a = &expected->tokens;
+    const TokenBuffer *b = &got->tokens;
+    if (a->type[pos] != b->type[pos] || a->offset[pos] != b->offset[pos]) {
+        return false;
+    }
+
+    switch ((NodeTypes)a->type[pos]) {
+        case kOperation:
+            return a->value[pos].operation == b->value[pos].operation;
+        case kNumber:
+            return memcmp(&a->value[pos].number, &b->value[pos].number, sizeof(double)) == 0;
+        case kVariable:
+            return strcmp(expected->arr.var_array[a->value[pos].pos].variable_name,
+                          got->arr.var_array[b->value[pos].pos].variable_name) == 0;
+        case kBlock: // the lexers never emit blocks
+        default:
+            return false;
+    }
+}
+
+static void PrintToken(FILE *out, const LexRun *run, size_t pos) {
+    assert(out);
+    assert(run);
+
+    if (pos >= run->tokens.size) {
+        fprintf(out, "end of tokens");
+        return;
+    }
+
+    const TokenBuffer *tokens = &run->tokens;
+    switch ((NodeTypes)tokens->type[pos]) {
+        case kOperation:
+            fprintf(out, "operation \"%s\"", NAME_TYPES_TABLE[tokens->value[pos].operation].name_in_lang);
+            break;
+        case kNumber:
+            fprintf(out, "number %g", tokens->value[pos].number);
+            break;
+        case kVariable:
+            fprintf(out, "variable \"%s\"", run->arr.var_array[tokens->value[pos].pos].variable_name);
+            break;
+        case kBlock:
+        default:
+            fprintf(out, "token of type %d", tokens->type[pos]);
+            break;
+    }
+}
+
+static void PrintPosition(FILE *out, const FileInfo *Info, size_t offset) {
+    assert(out);
+    assert(Info);
+
+    size_t line = 1;
+    size_t col  = 1;
+    for (size_t i = 0; i < offset && i < Info->filesize; i++) {
+        if (Info->buf_ptr[i] == '\n') {
+            line++;
+            col = 1;
+        } else {
+            col++;
+        }
+    }
+
+    fprintf(out, " at %zu:%zu\n", line, col);
+}
+
+static double Speed(double amount, double seconds) {
+    return seconds > 0 ? amount / seconds : 0;
+}
+
+static double Seconds(void) {
+    struct timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
\ No newline at end of file
@@ -8,44 +8,43 @@
 
 #include "Common/Enums.h"
 #include "Common/Structs.h"
-#include "Common/StackFunctions.h"
 #include "Common/LanguageFunctions.h"
+#include "Common/TokenFunctions.h"
+#include "Common/TextScan.h"
+#include "Common/Numbers.h"
 #include "Front-End/Rules.h"
+#include "Front-End/FSM_LexicalAnalysis.h"
 
 
-static bool TryParseOperation(Language *lang_info, const char **string, bool *flag_found);
-static bool SkipComment(const char **string);
-static void SkipSpaces(const char **string);
-static void SkipEmptyLines(const char **string);
-static bool ParseNumberToken(Language *lang_info, const char **string);
-static bool ParseStringToken(Language *lang_info, const char **string);
+static bool TryParseOperation(Language *lang_info, const char **string, const char *begin, bool *flag_found);
+static bool SkipComment(const char **string, const char *end);
+static void SkipSpaces(const char **string, const char *end);
+static bool ParseNumberToken(Language *lang_info, const char **string, const char *begin, bool *overflow);
+static void ReportOverflow(const char *begin, const char *token_start);
+static bool ParseStringToken(Language *lang_info, const char **string, const char *begin);
 
-#define NEWN(num) NewNode(lang_info, kNumber, ((Value){ .number = (num)}), NULL, NULL)
-#define NEWV(name) NewVariable(lang_info, name)
-#define NEWOP(op, left, right) NewNode(lang_info, kOperation, (Value){ .operation = (op)}, left, right) 
+#define PUSH_TOKEN(type, val, token_start) \
+    TokenBufferPush(lang_info->token_buf, (type), (val), (size_t)((token_start) - begin))
+#define PUSH_OP(op) PUSH_TOKEN(kOperation, ((Value){ .operation = (op) }), *string)
 
 #define CodeNameFromTable(type) NAME_TYPES_TABLE[type].name_in_lang
 
 #define CHECK_SYMBOL_AND_PUSH(symbol_to_check, op_type)                \
     if (**string == symbol_to_check) {                                 \
-        node = NEWOP(op_type, NULL, NULL);                             \
-        if (!node) {                                                   \
-            fprintf(stderr, "Error making new variable.\n");           \
-            return NULL;                                               \
+        if (PUSH_OP(op_type) != kSuccess) {                            \
+            fprintf(stderr, "Error pushing new operation.\n");         \
+            return 0;                                                  \
         }                                                              \
-        lang_info->tokens->la_size ++;                                 \
         (*string)++;                                                   \
         continue;                                                      \
     }
 
 #define CHECK_STROKE_AND_PUSH(line_to_check, op_type, flag_found)         \
     if ((strncmp(*string, line_to_check, strlen(line_to_check)) == 0)) {  \
-        node = NEWOP(op_type, NULL, NULL);                                \
-        if (!node) {                                                      \
-            fprintf(stderr, "Error making new operation.\n");             \
-            return NULL;                                                  \
+        if (PUSH_OP(op_type) != kSuccess) {                               \
+            fprintf(stderr, "Error pushing new operation.\n");            \
+            return false;                                                 \
         }                                                                 \
-        lang_info->tokens->la_size ++;                                    \
         (*string) += strlen(line_to_check);                               \
         flag_found = true; \
     }
@@ -54,34 +53,60 @@ size_t CheckAndReturn(Language *lang_info, const char **string) {
     assert(lang_info);
     assert(string);
 
-    LangNode_t *node = NULL;
+    return CheckAndReturnRange(lang_info, string, *string + strlen(*string));
+}
+
+size_t LexRange(Language *lang_info, const char **string, const char *end) {
+    assert(lang_info);
+    assert(string);
+    assert(end);
+
+    switch (lang_info->lexer) {
+        case kLexerFsm:
+            return CheckAndReturnRange_fsm(lang_info, string, end);
+        case kLexerTable:
+        default:
+            return CheckAndReturnRange(lang_info, string, end);
+    }
+}
+
+size_t CheckAndReturnRange(Language *lang_info, const char **string, const char *end) {
+    assert(lang_info);
+    assert(lang_info->token_buf);
+    assert(string);
+    assert(end);
+
     bool flag_found = false;
+    const char *begin = *string;
 
-    while (**string != '\0') {
-        SkipEmptyLines(string);
-        SkipSpaces(string);
-        if (**string == '\0') break;
+    while (*string < end && **string != '\0') {
+        SkipSpaces(string, end);
+        if (*string >= end || **string == '\0') break;
 
-        if (SkipComment(string)) {
+        if (SkipComment(string, end)) {
             continue;
         }
 
-        if (TryParseOperation(lang_info, string, &flag_found)) {
+        if (TryParseOperation(lang_info, string, begin, &flag_found)) {
             flag_found = false;
             continue;
         }
 
-        if (ParseNumberToken(lang_info, string)) {
+        bool overflow = false;
+        if (ParseNumberToken(lang_info, string, begin, &overflow)) {
             continue;
         }
+        if (overflow) {
+            return 0;
+        }
 
         CHECK_SYMBOL_AND_PUSH('-', kOperationSub);
 
-        if (ParseStringToken(lang_info, string)) {
+        if (ParseStringToken(lang_info, string, begin)) {
             continue;
         }
 
-        fprintf(stderr, "Lexer has stopped in '%c' (0x%02x), cnt=%zu, due to the lack of appropriate token type.\n", **string, **string, lang_info->tokens->la_size);
+        fprintf(stderr, "Lexer has stopped in '%c' (0x%02x), cnt=%zu, due to the lack of appropriate token type.\n", **string, **string, lang_info->token_buf->size);
 
         return 0;
     }
@@ -91,16 +116,16 @@ size_t CheckAndReturn(Language *lang_info, const char **string) {
     //     fprintf(stderr, "%s %d\n\n", Variable_Array->var_array[i].variable_name, Variable_Array->var_array[i].variable_value);
     // }
 
-    return lang_info->tokens->la_size;
+    return lang_info->token_buf->size;
 }
 
-static bool TryParseOperation(Language *lang_info, const char **string, bool *flag_found) {
+static bool TryParseOperation(Language *lang_info, const char **string, const char *begin, bool *flag_found) {
     assert(lang_info);
     assert(string);
+    assert(begin);
     assert(flag_found);
 
     *flag_found = false;
-    LangNode_t *node = NULL;
 
     for (size_t i = 0; i < OP_TABLE_SIZE; i++) {
         CHECK_STROKE_AND_PUSH(CodeNameFromTable((OperationTypes)i), (OperationTypes)i, *flag_found);
@@ -111,100 +136,80 @@ static bool TryParseOperation(Language *lang_info, const char **string, bool *fl
     return false;
 }
 
-static bool SkipComment(const char **string) {
+static bool SkipComment(const char **string, const char *end) {
     assert(string);
+    assert(end);
 
     if ((*string)[0] == '/' && (*string)[1] == '/') {
-        (*string) += 2;
-        while (**string != '\n') {
-            (*string)++;
-        }
+        *string = SkipToLineEnd(*string + 2, end);
         return true;
     }
 
     if ((*string)[0] == '/' && (*string)[1] == '*') {
-        (*string) += 2;
-        while (**string != '\0' && !((*string)[0] == '*' && (*string)[1] == '/')) {
-            (*string)++;
-        }
-        if (**string != '\0') {
-            (*string) += 2;
-        }
+        *string = SkipBlockComment(*string + 2, end, NULL, NULL);
         return true;
     }
 
     return false;
 }
 
-static void SkipSpaces(const char **string) {
+static void SkipSpaces(const char **string, const char *end) {
     assert(string);
+    assert(end);
 
-    while (**string != '\0' && isspace((unsigned char)**string) && **string != '\n') {
-        (*string)++;
-    }
+    *string = SkipBlanks(*string, end, NULL, NULL);
 }
 
-static void SkipEmptyLines(const char **string) {
-    assert(string);
-
-    for (;;) {
-        const char *ptr = *string;
-
-        while (*ptr != '\0' && isspace((unsigned char)*ptr) && *ptr != '\n') {
-            ptr++;
-        }
-
-        if (*ptr == '\n') {
-            ptr++;
-            *string = ptr;
-            continue;
-        }
-
-        break;
-    }
-}
-
-static bool ParseNumberToken(Language *lang_info, const char **string) {
+// A literal that does not fit into a double stops the lexer, as it does the FSM one,
+// instead of being taken for a name.
+static bool ParseNumberToken(Language *lang_info, const char **string, const char *begin, bool *overflow) {
     assert(lang_info);
     assert(string);
-
-    if (!(('0' <= **string && **string <= '9') || **string == '-'))
-        return false;
-
-    bool has_minus = false;
-    if (**string == '-') {
-        has_minus = true;
-        (*string)++;
-
-        if (!(**string >= '0' && **string <= '9')) {
-            (*string)--;
-            return false;
+    assert(begin);
+    assert(overflow);
+
+    double value = 0;
+    const char *token_start = *string;
+    const char *token_end = ScanNumber(token_start, &value);
+    if (!token_end) {
+        const char *digits = token_start + (*token_start == '-');
+        *overflow = isdigit((unsigned char)*digits) != 0;
+        if (*overflow) {
+            ReportOverflow(begin, token_start);
         }
+        return false;
     }
 
-    int value = 0;
-    do {
-        value = 10 * value + (**string - '0');
-        (*string)++;
+    if (PUSH_TOKEN(kNumber, ((Value){ .number = value }), token_start) != kSuccess) {
+        fprintf(stderr, "Error pushing new number.\n");
+    }
+    *string = token_end;
 
-    } while ('0' <= **string && **string <= '9');
+    return true;
+}
 
-    if (has_minus) {
-        value = -value;
-    }
+static void ReportOverflow(const char *begin, const char *token_start) {
+    assert(begin);
+    assert(token_start);
 
-    LangNode_t *node = NEWN(value);
-    if (!node) {
-        fprintf(stderr, "Error making new variable.\n");
+    size_t line = 1;
+    size_t col  = 1;
+    for (const char *ptr = begin; ptr < token_start; ptr++) {
+        if (*ptr == '\n') {
+            line++;
+            col = 1;
+        } else {
+            col++;
+        }
     }
 
-    lang_info->tokens->la_size ++;
-    return true;
+    fprintf(stderr, "Lexer error [%zu:%zu]: number does not fit into a double.\n", line, col);
 }
 
-static bool ParseStringToken(Language *lang_info, const char **string) {
+static bool ParseStringToken(Language *lang_info, const char **string, const char *begin) {
     assert(lang_info);
     assert(string);
+    assert(begin);
 
     if (!(isalnum(**string) || **string == '_')) {
         return false;
@@ -218,21 +223,12 @@ static bool ParseStringToken(Language *lang_info, const char **string) {
         len++;
     }
 
-    char *name = (char *) calloc (len + 1, 1);
-    if (!name) {
-        fprintf(stderr, "Error making new name in calloc.\n");
-        return false;
-    }
-
-    strncpy(name, name_start, len);
-    name[len] = '\0';
-
-    LangNode_t *node = NEWV(name); 
-    if (!node) {
+    size_t var_pos = 0;
+    if (InternVariable(lang_info->arr, name_start, len, &var_pos) != kSuccess
+            || PUSH_TOKEN(kVariable, ((Value){ .pos = var_pos }), name_start) != kSuccess) {
         fprintf(stderr, "Error making new variable.\n");
         return false;
     }
 
-    lang_info->tokens->la_size ++;
     return true;
 }
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include "Front-End/ParallelLexer.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+#include "Common/LanguageFunctions.h"
+#include "Common/TokenFunctions.h"
+#include "Common/TextScan.h"
+#include "Front-End/LexicalAnalysis.h"
+
+// The source is cut right before `incantatio` keywords that follow a blank outside of
+// comments. Functions do not nest, so these are the top-level declarations, and the
+// sequential lexer starts a fresh token there too: every chunk lexes exactly as it
+// would in one pass. Chunks get private name tables that are folded into the shared
+// one in source order, which keeps variable positions identical.
+
+struct LexChunk {
+    const char *begin;
+    const char *end;
+    VariableArr arr;
+    TokenBuffer tokens;
+    LexerKinds lexer;
+    bool stopped;
+};
+
+static LangErrors FindFunctionStarts(const char *buf, size_t size, size_t **starts, size_t *count);
+static size_t SplitChunks(const char *buf, size_t size, const size_t *starts, size_t count, LexChunk *chunks, size_t threads);
+static void *LexChunkWorker(void *arg);
+static LangErrors MergeChunk(Language *lang_info, const LexChunk *chunk, size_t base);
+static bool IsBlankChar(char c);
+
+LangErrors LexParallel(Language *lang_info, const char *buf, size_t size, size_t threads) {
+    assert(lang_info);
+    assert(lang_info->token_buf);
+    assert(buf);
+
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    if (size > UINT32_MAX) {
+        fprintf(stderr, "Source of %zu bytes does not fit into the token buffer.\n", size);
+        return kFailure;
+    }
+
+    size_t *starts = NULL;
+    size_t count = 0;
+    LangErrors err = FindFunctionStarts(buf, size, &starts, &count);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    LexChunk *chunks = (LexChunk *) calloc (threads, sizeof(LexChunk));
+    pthread_t *workers = (pthread_t *) calloc (threads, sizeof(pthread_t));
+    bool *started = (bool *) calloc (threads, sizeof(bool));
+    if (!chunks || !workers || !started) {
+        free(starts);
+        free(chunks);
+        free(workers);
+        free(started);
+        return kNoMemory;
+    }
+
+    size_t chunks_cnt = SplitChunks(buf, size, starts, count, chunks, threads);
+    free(starts);
+
+    for (size_t i = 0; i < chunks_cnt && err == kSuccess; i++) {
+        chunks[i].lexer = lang_info->lexer;
+        err = InitArrOfVariable(&chunks[i].arr, 16);
+        if (err == kSuccess) {
+            err = TokenBufferCtor(&chunks[i].tokens, (size_t)(chunks[i].end - chunks[i].begin) / 4);
+        }
+    }
+
+    for (size_t i = 1; i < chunks_cnt && err == kSuccess; i++) {
+        started[i] = pthread_create(&workers[i], NULL, LexChunkWorker, &chunks[i]) == 0;
+        if (!started[i]) {
+            LexChunkWorker(&chunks[i]);
+        }
+    }
+    if (chunks_cnt > 0 && err == kSuccess) {
+        LexChunkWorker(&chunks[0]);
+    }
+
+    for (size_t i = 1; i < chunks_cnt; i++) {
+        if (started[i]) {
+            pthread_join(workers[i], NULL);
+        }
+    }
+
+    for (size_t i = 0; i < chunks_cnt && err == kSuccess; i++) {
+        err = MergeChunk(lang_info, &chunks[i], (size_t)(chunks[i].begin - buf));
+        if (chunks[i].stopped) {
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < chunks_cnt; i++) {
+        DtorVariableArray(&chunks[i].arr);
+        TokenBufferDtor(&chunks[i].tokens);
+    }
+    free(chunks);
+    free(workers);
+    free(started);
+
+    return err;
+}
+
+static LangErrors FindFunctionStarts(const char *buf, size_t size, size_t **starts, size_t *count) {
+    assert(buf);
+    assert(starts);
+    assert(count);
+
+    const char *keyword = NAME_TYPES_TABLE[kOperationFunction].name_in_lang;
+    size_t keyword_len = strlen(keyword);
+
+    size_t capacity = 64;
+    *count = 0;
+    *starts = (size_t *) calloc (capacity, sizeof(size_t));
+    if (!*starts) {
+        return kNoMemory;
+    }
+
+    const char *ptr = buf;
+    const char *end = buf + size;
+    const char *keyword_pos = (const char *) memmem(ptr, size, keyword, keyword_len);
+
+    while (ptr < end) {
+        const char *limit = keyword_pos ? keyword_pos : end;
+        const char *slash = (const char *) memchr(ptr, '/', (size_t)(limit - ptr));
+
+        if (slash) {
+            if (slash + 1 < end && slash[1] == '/') {
+                ptr = SkipToLineEnd(slash + 2, end);
+            } else if (slash + 1 < end && slash[1] == '*') {
+                ptr = SkipBlockComment(slash + 2, end, NULL, NULL);
+            } else {
+                ptr = slash + 1;
+            }
+
+            if (keyword_pos && keyword_pos < ptr) {
+                keyword_pos = (const char *) memmem(ptr, (size_t)(end - ptr), keyword, keyword_len);
+            }
+            continue;
+        }
+
+        if (!keyword_pos) {
+            break;
+        }
+
+        if (keyword_pos > buf && IsBlankChar(keyword_pos[-1])) {
+            if (*count == capacity) {
+                size_t *new_starts = (size_t *) realloc (*starts, 2 * capacity * sizeof(size_t));
+                if (!new_starts) {
+                    free(*starts);
+                    *starts = NULL;
+                    return kNoMemory;
+                }
+                *starts = new_starts;
+                capacity *= 2;
+            }
+
+            (*starts)[(*count)++] = (size_t)(keyword_pos - buf);
+        }
+
+        ptr = keyword_pos + keyword_len;
+        keyword_pos = (const char *) memmem(ptr, (size_t)(end - ptr), keyword, keyword_len);
+    }
+
+    return kSuccess;
+}
+
+static size_t SplitChunks(const char *buf, size_t size, const size_t *starts, size_t count, LexChunk *chunks, size_t threads) {
+    assert(buf);
+    assert(chunks);
+
+    size_t chunks_cnt = 0;
+    size_t chunk_begin = 0;
+    size_t next_start = 0;
+
+    for (size_t k = 1; k < threads; k++) {
+        size_t target = size / threads * k;
+        while (next_start < count && (starts[next_start] < target || starts[next_start] <= chunk_begin)) {
+            next_start++;
+        }
+        if (next_start == count) {
+            break;
+        }
+
+        chunks[chunks_cnt].begin = buf + chunk_begin;
+        chunks[chunks_cnt].end   = buf + starts[next_start];
+        chunks_cnt++;
+        chunk_begin = starts[next_start];
+    }
+
+    chunks[chunks_cnt].begin = buf + chunk_begin;
+    chunks[chunks_cnt].end   = buf + size;
+
+    return chunks_cnt + 1;
+}
+
+static void *LexChunkWorker(void *arg) {
+    assert(arg);
+
+    LexChunk *chunk = (LexChunk *)arg;
+
+    Language lang_info = {};
+    lang_info.arr       = &chunk->arr;
+    lang_info.token_buf = &chunk->tokens;
+    lang_info.lexer     = chunk->lexer;
+
+    const char *ptr = chunk->begin;
+    LexRange(&lang_info, &ptr, chunk->end);
+    chunk->stopped = ptr < chunk->end;
+
+    return NULL;
+}
+
+static LangErrors MergeChunk(Language *lang_info, const LexChunk *chunk, size_t base) {
+    assert(lang_info);
+    assert(chunk);
+
+    size_t *remap = (size_t *) calloc (chunk->arr.size + 1, sizeof(size_t));
+    if (!remap) {
+        return kNoMemory;
+    }
+
+    LangErrors err = kSuccess;
+    for (size_t i = 0; i < chunk->arr.size && err == kSuccess; i++) {
+        const char *name = chunk->arr.var_array[i].variable_name;
+        err = InternVariable(lang_info->arr, name, strlen(name), &remap[i]);
+    }
+
+    TokenBuffer *tokens = lang_info->token_buf;
+    if (err == kSuccess) {
+        err = TokenBufferReserve(tokens, tokens->size + chunk->tokens.size);
+    }
+    if (err != kSuccess) {
+        free(remap);
+        return err;
+    }
+
+    memcpy(tokens->type + tokens->size, chunk->tokens.type, chunk->tokens.size);
+    for (size_t i = 0; i < chunk->tokens.size; i++) {
+        Value value = chunk->tokens.value[i];
+        if (chunk->tokens.type[i] == kVariable) {
+            value.pos = remap[value.pos];
+        }
+        tokens->value[tokens->size + i]  = value;
+        tokens->offset[tokens->size + i] = (uint32_t)(base + chunk->tokens.offset[i]);
+    }
+    tokens->size += chunk->tokens.size;
+
+    free(remap);
+    return kSuccess;
+}
+
+static bool IsBlankChar(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
\ No newline at end of file
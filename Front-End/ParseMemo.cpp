@@ -0,0 +1,165 @@
+#include "Front-End/ParseMemo.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+// Packrat table for the rules the parser retries from the same token: (rule, position)
+// maps to the node the rule built, or NULL, and the position it stopped at.
+// Entries belong to one function body, so forgetting them is a generation bump.
+
+static LangErrors ParseMemoRehash(ParseMemo *memo, size_t new_capacity);
+static size_t ParseMemoProbeStart(const ParseMemo *memo, MemoRules rule, size_t pos);
+
+LangErrors ParseMemoCtor(ParseMemo *memo, size_t capacity) {
+    assert(memo);
+
+    memo->entries      = NULL;
+    memo->size         = 0;
+    memo->capacity     = 0;
+    memo->generation   = 1;
+    memo->lookups      = 0;
+    memo->hits         = 0;
+    memo->tokens_saved = 0;
+
+    size_t slots = 16;
+    while (slots < capacity * 2) {
+        slots *= 2;
+    }
+
+    return ParseMemoRehash(memo, slots);
+}
+
+void ParseMemoDtor(ParseMemo *memo) {
+    if (!memo) {
+        return;
+    }
+
+    free(memo->entries);
+    memo->entries  = NULL;
+    memo->size     = 0;
+    memo->capacity = 0;
+}
+
+void ParseMemoForget(ParseMemo *memo) {
+    assert(memo);
+
+    memo->size = 0;
+    memo->generation++;
+    if (memo->generation == 0) {
+        memset(memo->entries, 0, memo->capacity * sizeof(MemoEntry));
+        memo->generation = 1;
+    }
+}
+
+bool ParseMemoFind(ParseMemo *memo, MemoRules rule, size_t pos, size_t func_pos, LangNode_t **node, size_t *end) {
+    assert(memo);
+    assert(node);
+    assert(end);
+
+    memo->lookups++;
+
+    size_t mask = memo->capacity - 1;
+    for (size_t i = ParseMemoProbeStart(memo, rule, pos); memo->entries[i].generation == memo->generation; i = (i + 1) & mask) {
+        const MemoEntry *entry = &memo->entries[i];
+        if (entry->pos != pos || entry->rule != rule) {
+            continue;
+        }
+        if (entry->func_pos != func_pos) {
+            return false;
+        }
+
+        *node = entry->node;
+        *end  = entry->end;
+        memo->hits++;
+        memo->tokens_saved += entry->end - entry->pos;
+        return true;
+    }
+
+    return false;
+}
+
+void ParseMemoStore(ParseMemo *memo, MemoRules rule, size_t pos, size_t func_pos, LangNode_t *node, size_t end) {
+    assert(memo);
+
+    if (end > UINT32_MAX || func_pos > UINT32_MAX) {
+        return;
+    }
+
+    if ((memo->size + 1) * 2 > memo->capacity && ParseMemoRehash(memo, memo->capacity * 2) != kSuccess) {
+        return;
+    }
+
+    size_t mask = memo->capacity - 1;
+    size_t i = ParseMemoProbeStart(memo, rule, pos);
+    while (memo->entries[i].generation == memo->generation) {
+        if (memo->entries[i].pos == pos && memo->entries[i].rule == rule) {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+
+    if (memo->entries[i].generation != memo->generation) {
+        memo->size++;
+    }
+
+    memo->entries[i].node       = node;
+    memo->entries[i].pos        = (uint32_t)pos;
+    memo->entries[i].end        = (uint32_t)end;
+    memo->entries[i].func_pos   = (uint32_t)func_pos;
+    memo->entries[i].generation = memo->generation;
+    memo->entries[i].rule       = rule;
+}
+
+void ParseMemoPrintStats(const ParseMemo *memo, FILE *out) {
+    assert(memo);
+    assert(out);
+
+    fprintf(out, "Parse memo: %zu lookups, %zu re-parses avoided, %zu tokens not parsed again.\n",
+            memo->lookups, memo->hits, memo->tokens_saved);
+}
+
+static size_t ParseMemoProbeStart(const ParseMemo *memo, MemoRules rule, size_t pos) {
+    assert(memo);
+
+    uint32_t hash = (uint32_t)(pos * 4 + rule) * 2654435761u;
+    return (size_t)hash & (memo->capacity - 1);
+}
+
+static LangErrors ParseMemoRehash(ParseMemo *memo, size_t new_capacity) {
+    assert(memo);
+
+    MemoEntry *new_entries = (MemoEntry *) calloc (new_capacity, sizeof(MemoEntry));
+    if (!new_entries) {
+        fprintf(stderr, "Memory error.\n");
+        return kNoMemory;
+    }
+
+    size_t mask = new_capacity - 1;
+    ParseMemo resized = *memo;
+    resized.entries  = new_entries;
+    resized.capacity = new_capacity;
+
+    for (size_t i = 0; i < memo->capacity; i++) {
+        if (memo->entries[i].generation != memo->generation) {
+            continue;
+        }
+
+        size_t j = ParseMemoProbeStart(&resized, memo->entries[i].rule, memo->entries[i].pos);
+        while (new_entries[j].generation == memo->generation) {
+            j = (j + 1) & mask;
+        }
+        new_entries[j] = memo->entries[i];
+    }
+
+    free(memo->entries);
+    memo->entries  = new_entries;
+    memo->capacity = new_capacity;
+
+    return kSuccess;
+}
\ No newline at end of file
@@ -7,13 +7,23 @@
 #include <assert.h>
 #include <math.h>
 #include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
 #include <ctype.h>
 #include <sys/stat.h>
+#include <pthread.h>
 
 #include "Common/LanguageFunctions.h"
-#include "Common/StackFunctions.h"
+#include "Common/TokenFunctions.h"
 #include "Common/DoGraph.h"
+#include "Common/TextScan.h"
+#include "Common/Locations.h"
+#include "Common/Numbers.h"
+#include "Common/NodeArena.h"
 #include "Front-End/LexicalAnalysis.h"
+#include "Front-End/FSM_LexicalAnalysis.h"
+#include "Front-End/ParallelLexer.h"
+#include "Front-End/ParseMemo.h"
 #include "Common/CommonFunctions.h"
 
 #define CHECK_NULL_RETURN(name, cond) \
@@ -31,15 +41,19 @@
         *(lang_info->tokens_pos) = save_pos;    \
     } while (0)
 
-#define CHECK_EXPECTED_TOKEN(out_tok, TRUE_COND, error_handler)                  \
-    do {                                                                         \
-        (out_tok) = GetStackElem((lang_info->tokens), *(lang_info->tokens_pos)); \
-        if (!(TRUE_COND)) {                                                      \
-            error_handler;                                                       \
-            *(lang_info->tokens_pos) = (save_pos);                               \
-            return NULL;                                                         \
-        }                                                                        \
-        (*lang_info->tokens_pos)++;                                              \
+#define IS_TOKEN_OP(pos, op)     IsTokenOperation(lang_info->token_buf, (pos), (op))
+#define IS_TOKEN_TYPE(pos, type) IsTokenType(lang_info->token_buf, (pos), (type))
+#define TOKEN_VAR_POS(tok)       (lang_info->token_buf->value[(tok)].pos)
+
+#define CHECK_EXPECTED_TOKEN(out_tok, TRUE_COND, error_handler) \
+    do {                                                        \
+        (out_tok) = *(lang_info->tokens_pos);                   \
+        if (!(TRUE_COND)) {                                     \
+            error_handler;                                      \
+            *(lang_info->tokens_pos) = (save_pos);              \
+            return NULL;                                        \
+        }                                                       \
+        (*lang_info->tokens_pos)++;                             \
     } while (0)
 
 #define TRY_PARSE_FUNC_AND_RETURN_NULL(result, call, error_handler) \
@@ -52,258 +66,1391 @@
         }                                                                 \
     } while (0)
 
+#define RETURN_MEMOIZED(rule, func_pos, call)                                             \
+    do {                                                                                  \
+        size_t memo_pos = *lang_info->tokens_pos;                                         \
+        LangNode_t *memo_node = NULL;                                                     \
+        if (lang_info->memo && ParseMemoFind(lang_info->memo, (rule), memo_pos, (func_pos), \
+                                             &memo_node, lang_info->tokens_pos)) {        \
+            return memo_node;                                                             \
+        }                                                                                 \
+        memo_node = (call);                                                               \
+        if (lang_info->memo) {                                                            \
+            ParseMemoStore(lang_info->memo, (rule), memo_pos, (func_pos),                 \
+                           memo_node, *lang_info->tokens_pos);                            \
+        }                                                                                 \
+        return memo_node;                                                                 \
+    } while (0)
+
+
+#define DEFINE_SIMPLE_COMMAND_PARSER(func_name, op_type)             \
+static LangNode_t *func_name(Language *lang_info, size_t func_pos) { \
+    assert(lang_info);                                               \
+    (void)func_pos;                                                  \
+                                                                     \
+    size_t save_pos = *(lang_info->tokens_pos);                      \
+    size_t name = 0, tok = 0;                                        \
+                                                                     \
+    CHECK_EXPECTED_TOKEN(name, IS_TOKEN_OP(name, op_type), );        \
+    CHECK_EXPECTED_TOKEN(tok,  IS_TOKEN_OP(tok, kOperationThen), );  \
+                                                                     \
+    return NodeFromToken(lang_info, name);                           \
+}
+
+
+enum Mention : unsigned char {
+    kMentionBefore = 1,
+    kMentionInside = 2,
+    kMentionBehind = 4,
+};
+
+struct LazyFunction {
+    size_t token; // its `incantatio`
+    size_t end;   // the next `incantatio` or the end of the tokens
+    size_t name;
+    size_t next;  // 1 + the next function of the same name, 0 for none
+    bool reached;
+};
+
+struct ParseTask {
+    size_t begin;  // its first `incantatio`
+    size_t end;    // the first `incantatio` of the next task
+    size_t stop;   // where its worker left off
+    LangRoot root; // private arena of the subtrees
+    VariableArr arr;
+    ParseMemo memo;
+    LangNode_t *block;
+    bool failed;
+    LangErrors error;
+};
+
+struct ParsePool {
+    const Language *lang_info;
+    const VariableArr *names; // the table before any function was parsed
+    ParseTask *tasks;
+    size_t tasks_cnt;
+    size_t next; // first task no worker has taken
+    pthread_mutex_t lock;
+};
+
+static const size_t PARSE_TASKS_PER_THREAD = 4;
+
+struct InfixFrame {
+    LangNode_t *left; // NULL for an open parenthesis
+    size_t op_tok;
+    unsigned char min_power;
+};
+
+static const size_t INFIX_LOCAL_FRAMES = 16;
+
+struct InfixStack {
+    InfixFrame *frames;
+    size_t size;
+    size_t capacity;
+    InfixFrame local[INFIX_LOCAL_FRAMES];
+};
+
+static LangNode_t *GetGoal(Language *lang_info);
+static LangNode_t *GetReachableGoal(Language *lang_info);
+static LangNode_t *GetGoalParallel(Language *lang_info);
+static LangNode_t *GetAssignment(Language *lang_info, size_t func_pos);
+static LangNode_t *GetOp(Language *lang_info, size_t func_pos);
+static LangNode_t *GetFunctionDeclare(Language *lang_info);
+static LangNode_t *GetFunctionCall(Language *lang_info);
+static LangNode_t *ParseFunctionCall(Language *lang_info);
+
+static LangNode_t *GetWhile(Language *lang_info, size_t func_pos);
+static LangNode_t *GetIf(Language *lang_info, size_t func_pos);
+static LangNode_t *GetElse(Language *lang_info, LangNode_t *if_node, size_t func_pos);
+static LangNode_t *GetCondition(Language *lang_info, size_t func_pos);
+static LangNode_t *GetReturn(Language *lang_info, size_t func_pos);
+static LangNode_t *GetPrintf(Language *lang_info, size_t func_pos);
+static LangNode_t *GetScanf(Language *lang_info, size_t func_pos);
+static LangNode_t *GetUnaryFunc(Language *lang_info, size_t func_pos);
+static LangNode_t *GetHLT(Language *lang_info, size_t func_pos);
+static LangNode_t *GetDraw(Language *lang_info, size_t func_pos);
+
+static LangNode_t *GetStatement(Language *lang_info, size_t func_pos);
+static LangNode_t *GetExpression(Language *lang_info, size_t func_pos);
+static LangNode_t *ParseExpression(Language *lang_info, size_t func_pos);
+static LangNode_t *ParseInfix(Language *lang_info, size_t func_pos, unsigned char min_power);
+static bool InfixPush(InfixStack *stack, LangNode_t *left, size_t op_tok, unsigned char min_power);
+static LangNode_t *GetPrimary(Language *lang_info, size_t func_pos);
+static LangNode_t *GetTernary(Language *lang_info, size_t func_pos);
+
+static LangNode_t *GetVariableAddr(Language *lang_info, size_t func_pos, ValCategory mode);
+static LangNode_t *GetNumber(Language *lang_info);
+static LangNode_t *GetString(Language *lang_info, size_t func_pos, ValCategory val_cat);
+static bool MatchString(Language *lang_info, size_t func_pos, ValCategory val_cat, size_t *token);
+static bool SyncFuncMade(VariableArr *arr, size_t var_pos, size_t func_pos, ValCategory val_cat);
+static LangNode_t *GetArrayElement(Language *lang_info, size_t func_pos);
+
+static LangNode_t *ParseFunctionArgs(Language *lang_info, size_t *cnt, size_t func_pos);
+static LangNode_t *ParseBody(Language *lang_info, size_t func_pos);
+
+static LangNode_t *GetArrayAssignment(Language *lang_info, size_t func_pos);
+static LangNode_t *GetAssignmentLValue(Language *lang_info, size_t func_pos);
+static LangNode_t *ParseAssignmentLValue(Language *lang_info, size_t func_pos);
+static LangNode_t *ParseAssignmentRValue(Language *lang_info, size_t func_pos, LangNode_t *lvalue);
+static LangNode_t *ParseAddrToken(Language *lang_info, LangNode_t *token);
+static bool CheckAndSetFunctionArgsNumber(Language *lang_info, size_t var_pos, size_t cnt);
+static bool CheckArrayPos(VariableArr *arr, size_t var_pos, LangNode_t *number);
+static LangNode_t *ParseSimpleAssignment(Language *lang_info, size_t func_pos);
+static bool CheckCompareSign(const TokenBuffer *tokens, size_t pos);
+static void ConnectParentAndChild(LangNode_t *parent, LangNode_t *child, ChildNode node_type);
+static LangNode_t *NodeFromToken(Language *lang_info, size_t pos);
+static LangNode_t *FoldLiterals(Language *lang_info, LangNode_t *node);
+
+static LangErrors ReparseAll(Language *lang_info, FrontState *state);
+static size_t RelexDamaged(Language *lang_info, FrontState *state, size_t first, const SourceEdit *edit, TokenBuffer *damaged, bool *stopped);
+static bool IsNextTokenAt(const char *src, size_t size, size_t from, size_t stop);
+static size_t TokenLength(Language *lang_info, const TokenBuffer *tokens, size_t pos, const char *src);
+static LangErrors ParseFunctions(Language *lang_info, FrontState *state, size_t end, bool *complete);
+static LangErrors LinkFunctions(Language *lang_info, FrontState *state, size_t from);
+static LangErrors ReserveFunctions(FrontState *state, size_t capacity);
+static size_t FindFunction(const FrontState *state, size_t offset);
+static size_t ShiftOffset(size_t offset, const SourceEdit *edit);
+static void ReleaseOwnedVariables(VariableArr *arr, size_t func_pos);
+static void MarkMentions(const TokenBuffer *tokens, size_t from, size_t to, unsigned char *mentions, Mention mention);
+static LangErrors SpliceSource(FrontState *state, const SourceEdit *edit);
+static void ReachFunctions(LazyFunction *funcs, const size_t *first, size_t name, size_t *queue, size_t *queue_size);
+static LangErrors SplitParseTasks(const TokenBuffer *tokens, size_t parts, ParseTask **tasks, size_t *tasks_cnt);
+static void *ParseTaskWorker(void *arg);
+static void RunParseTask(const ParsePool *pool, ParseTask *task);
+static bool IsTaskValid(const Language *lang_info, const VariableArr *names, const ParseTask *task);
+static void ApplyTask(VariableArr *arr, const VariableArr *names, ParseTask *task);
+static bool ParseDeclarations(Language *lang_info, LangNode_t *program, size_t end);
+static LangErrors CopyVariables(VariableArr *to, const VariableArr *from);
+static void DropVariables(VariableArr *arr);
+
+typedef LangNode_t *(*StatementParser)(Language *lang_info, size_t func_pos);
+
+struct StatementRule {
+    OperationTypes leading;
+    StatementParser parser;
+};
+
+struct StatementDispatch {
+    StatementParser parser[kOperationNone + 1];
+};
+
+// Statements told apart by their first token, everything else starts with a name.
+static constexpr StatementRule STATEMENT_RULES[] = {
+    {kOperationReturn,    GetReturn},
+    {kOperationWrite,     GetPrintf},
+    {kOperationWriteChar, GetPrintf},
+    {kOperationRead,      GetScanf},
+    {kOperationWhile,     GetWhile},
+    {kOperationIf,        GetIf},
+    {kOperationHLT,       GetHLT},
+    {kOperationDraw,      GetDraw},
+};
+
+constexpr StatementDispatch BuildStatementDispatch(const StatementRule *rules, size_t count) {
+    StatementDispatch dispatch = {};
+
+    for (size_t i = 0; i < count; i++) {
+        dispatch.parser[rules[i].leading] = rules[i].parser;
+    }
+
+    return dispatch;
+}
+
+static constexpr StatementDispatch STATEMENT_DISPATCH =
+    BuildStatementDispatch(STATEMENT_RULES, sizeof(STATEMENT_RULES) / sizeof(STATEMENT_RULES[0]));
+
+LangErrors ReadInfix(Language *lang_info, DumpInfo *dump_info, const char *filename) {
+    assert(lang_info);
+    assert(dump_info);
+    assert(filename);
+
+    return ReadInfixParallel(lang_info, dump_info, filename, 1);
+}
+
+LangErrors ReadInfixParallel(Language *lang_info, DumpInfo *dump_info, const char *filename, size_t threads) {
+    assert(lang_info);
+    assert(dump_info);
+    assert(filename);
+
+    FILE_OPEN_AND_CHECK(file, filename, "r", NULL, NULL);
+
+    FileInfo Info = {};
+    LangErrors err = DoBufRead(file, filename, &Info);
+    fclose(file);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    TokenBuffer token_buf = {};
+    if (TokenBufferCtor(&token_buf, Info.filesize / 4) != kSuccess) {
+        DoBufFree(&Info);
+        return kNoMemory;
+    }
+    lang_info->token_buf = &token_buf;
+
+    if (threads > 1) {
+        err = LexParallel(lang_info, Info.buf_ptr, Info.filesize, threads);
+    } else {
+        const char *temp_buf_ptr = Info.buf_ptr;
+        LexRange(lang_info, &temp_buf_ptr, Info.buf_ptr + Info.filesize);
+    }
+    if (err == kSuccess && lang_info->locate) {
+        err = LocateTokens(&lang_info->root->locations, &token_buf, Info.buf_ptr);
+    }
+    DoBufFree(&Info);
+
+    if (err != kSuccess) {
+        TokenBufferDtor(&token_buf);
+        lang_info->token_buf = NULL;
+        return err;
+    }
+
+    size_t tokens_pos = 0;
+    lang_info->tokens_pos = &tokens_pos;
+
+    if (lang_info->lazy) {
+        lang_info->root->root = GetReachableGoal(lang_info);
+    } else if (lang_info->parse_threads > 1) {
+        lang_info->root->root = GetGoalParallel(lang_info);
+    } else {
+        lang_info->root->root = GetGoal(lang_info);
+    }
+
+    TokenBufferDtor(&token_buf);
+    lang_info->token_buf = NULL;
+
+    if (!lang_info->root->root) {
+        return kFailure;
+    }
+    
+    DoTreeInGraphviz(lang_info->root->root, dump_info, lang_info->arr);
+
+    return kSuccess;
+}
+
+#define NEWN(num) NewNode(lang_info, kNumber, ((Value){ .number = (num)}), NULL, NULL)
+#define NEWOP(op, left, right) NewNode(lang_info, kOperation, (Value){ .operation = (op) }, left, right) 
+
+LangErrors ReadInfixStream(Language *lang_info, DumpInfo *dump_info, const char *filename, size_t chunk_size) {
+    assert(lang_info);
+    assert(dump_info);
+    assert(filename);
+
+    FILE_OPEN_AND_CHECK(file, filename, "r", NULL, NULL);
+
+    FsmStream *stream = NULL;
+    LangErrors err = FsmStreamCtor(&stream, file, chunk_size);
+    if (err != kSuccess) {
+        fclose(file);
+        return err;
+    }
+
+    TokenBuffer token_buf = {};
+    if (TokenBufferCtor(&token_buf, 0) != kSuccess) {
+        FsmStreamDtor(stream);
+        fclose(file);
+        return kNoMemory;
+    }
+    lang_info->token_buf = &token_buf;
+
+    size_t tokens_pos = 0;
+    lang_info->tokens_pos = &tokens_pos;
+
+    LangNode_t *program = NewBlock(lang_info);
+    while (program) {
+        TokenBufferClear(&token_buf);
+        tokens_pos = 0;
+
+        size_t cnt = 0;
+        err = CheckAndReturnFunction_fsm(lang_info, stream, &cnt);
+        if (cnt == 0) {
+            break;
+        }
+
+        // A function that does not take exactly its batch would parse differently with the
+        // tokens behind it in sight, so the stream gives up instead of guessing.
+        LangNode_t *next = GetFunctionDeclare(lang_info);
+        if (err != kSuccess || !next || tokens_pos != token_buf.size) {
+            fprintf(stderr, "SYNTAX_ERROR_STREAM: function %zu does not parse as a whole.\n", program->value.block->size + 1);
+            err = err == kSuccess ? kSyntaxError : err;
+            break;
+        }
+
+        if (BlockAppend(program, next) != kSuccess) {
+            err = kNoMemory;
+            break;
+        }
+    }
+
+    TokenBufferDtor(&token_buf);
+    lang_info->token_buf = NULL;
+    FsmStreamDtor(stream);
+    fclose(file);
+
+    if (err != kSuccess || !program || program->value.block->size == 0) {
+        lang_info->root->root = NULL;
+        return err != kSuccess ? err : kFailure;
+    }
+    lang_info->root->root = program;
+
+    DoTreeInGraphviz(lang_info->root->root, dump_info, lang_info->arr);
+
+    return kSuccess;
+}
+
+LangErrors ReadInfixIncremental(Language *lang_info, DumpInfo *dump_info, const char *filename, FrontState *state) {
+    assert(lang_info);
+    assert(dump_info);
+    assert(filename);
+    assert(state);
+
+    FILE_OPEN_AND_CHECK(file, filename, "r", NULL, NULL);
+
+    FileInfo Info = {};
+    LangErrors err = DoBufRead(file, filename, &Info);
+    fclose(file);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    *state = {};
+    state->source = (char *) calloc (Info.filesize + 1, sizeof(char));
+    if (!state->source) {
+        DoBufFree(&Info);
+        return kNoMemory;
+    }
+    memcpy(state->source, Info.buf_ptr, Info.filesize);
+    state->size = Info.filesize;
+    DoBufFree(&Info);
+
+    err = TokenBufferCtor(&state->tokens, state->size / 4);
+    if (err != kSuccess) {
+        FrontStateDtor(state);
+        return err;
+    }
+
+    // The state stays usable even if this text does not parse, an edit may fix it.
+    err = ReparseAll(lang_info, state);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    DoTreeInGraphviz(lang_info->root->root, dump_info, lang_info->arr);
+
+    return kSuccess;
+}
+
+// Only the functions around the edit are lexed and parsed again: lexing restarts at the
+// function that holds the first edited byte and stops at the first old function start
+// behind the edit that the new tokens line up with. Subtrees of all other functions stay
+// where they are, only the program block above them is refilled.
+LangErrors ReadInfixEdit(Language *lang_info, FrontState *state, const SourceEdit *edit) {
+    assert(lang_info);
+    assert(state);
+    assert(edit);
+
+    if (edit->offset > state->size || edit->removed > state->size - edit->offset) {
+        fprintf(stderr, "Edit of %zu bytes at %zu is out of the source of %zu bytes.\n", edit->removed, edit->offset, state->size);
+        return kSyntaxError;
+    }
+
+    if (state->size - edit->removed + edit->inserted > UINT32_MAX) {
+        fprintf(stderr, "Edited source does not fit into the token buffer.\n");
+        return kFailure;
+    }
+
+    size_t first = FindFunction(state, edit->offset);
+    first = first ? first - 1 : 0;
+
+    LangErrors err = SpliceSource(state, edit);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    if (state->dirty || state->funcs_cnt == 0) {
+        return ReparseAll(lang_info, state);
+    }
+
+    TokenBuffer damaged = {};
+    err = TokenBufferCtor(&damaged, 0);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    bool stopped = false;
+    size_t resync = RelexDamaged(lang_info, state, first, edit, &damaged, &stopped);
+
+    size_t old_cnt  = state->funcs_cnt;
+    size_t from_tok = first ? state->funcs[first].token : 0;
+    size_t to_tok   = resync < old_cnt ? state->funcs[resync].token : state->tokens.size;
+    size_t end_tok  = from_tok + damaged.size;
+
+    err = TokenBufferSplice(&state->tokens, from_tok, to_tok, &damaged);
+    TokenBufferDtor(&damaged);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    for (size_t i = end_tok; i < state->tokens.size; i++) {
+        state->tokens.offset[i] = (uint32_t)ShiftOffset(state->tokens.offset[i], edit);
+    }
+
+    size_t reused_cnt = old_cnt - resync;
+    FrontFunction *reused = (FrontFunction *) calloc (reused_cnt + 1, sizeof(FrontFunction));
+    unsigned char *mentions = (unsigned char *) calloc (lang_info->arr->size + 1, sizeof(unsigned char));
+    int *params = (int *) calloc (lang_info->arr->size + 1, sizeof(int));
+    if (!reused || !mentions || !params) {
+        free(reused);
+        free(mentions);
+        free(params);
+        return kNoMemory;
+    }
+    memcpy(reused, state->funcs + resync, reused_cnt * sizeof(FrontFunction));
+
+    // A parameter count is fixed by the first mention of a function, so the functions
+    // parsed again must not see counts that only mentions behind them have set.
+    MarkMentions(&state->tokens, 0, from_tok, mentions, kMentionBefore);
+    MarkMentions(&state->tokens, from_tok, end_tok, mentions, kMentionInside);
+    MarkMentions(&state->tokens, end_tok, state->tokens.size, mentions, kMentionBehind);
+
+    for (size_t i = first; i < resync; i++) {
+        size_t name = state->funcs[i].node->left->value.pos;
+        ReleaseOwnedVariables(lang_info->arr, name);
+        mentions[name] |= kMentionInside;
+    }
+
+    VariableInfo *vars = lang_info->arr->var_array;
+    for (size_t i = 0; i < lang_info->arr->size; i++) {
+        if (mentions[i] == kMentionInside || mentions[i] == (kMentionInside | kMentionBehind)) {
+            params[i] = vars[i].params_number;
+            vars[i].params_number = POISON;
+        }
+    }
+
+    state->funcs_cnt = first;
+
+    size_t tokens_pos = from_tok;
+    lang_info->tokens_pos = &tokens_pos;
+    lang_info->token_buf  = &state->tokens;
+
+    bool complete = false;
+    err = ParseFunctions(lang_info, state, end_tok, &complete);
+    lang_info->token_buf = NULL;
+
+    bool arity_changed = false;
+    for (size_t i = 0; i < lang_info->arr->size; i++) {
+        if (mentions[i] == kMentionInside || mentions[i] == (kMentionInside | kMentionBehind)) {
+            if (vars[i].params_number == POISON) {
+                vars[i].params_number = params[i];
+            } else if ((mentions[i] & kMentionBehind) && vars[i].params_number != params[i]) {
+                arity_changed = true;
+            }
+        }
+    }
+    free(mentions);
+    free(params);
+
+    if (err != kSuccess || (complete && arity_changed)) {
+        free(reused);
+        // Calls behind the edit were checked against the old parameter count.
+        return err != kSuccess ? err : ReparseAll(lang_info, state);
+    }
+
+    if (complete && reused_cnt > 0) {
+        err = ReserveFunctions(state, state->funcs_cnt + reused_cnt);
+        if (err != kSuccess) {
+            free(reused);
+            return err;
+        }
+
+        for (size_t i = 0; i < reused_cnt; i++) {
+            reused[i].offset = ShiftOffset(reused[i].offset, edit);
+            reused[i].token  = reused[i].token - to_tok + end_tok;
+            state->funcs[state->funcs_cnt++] = reused[i];
+        }
+    }
+    free(reused);
+
+    state->dirty = stopped || !complete;
+
+    err = LinkFunctions(lang_info, state, first);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    return lang_info->root->root ? kSuccess : kFailure;
+}
+
+void FrontStateDtor(FrontState *state) {
+    if (!state) {
+        return;
+    }
+
+    free(state->source);
+    TokenBufferDtor(&state->tokens);
+    free(state->funcs);
+
+    *state = {};
+}
+
+static LangErrors ReparseAll(Language *lang_info, FrontState *state) {
+    assert(lang_info);
+    assert(state);
+
+    DtorVariableArray(lang_info->arr);
+    LangErrors err = InitArrOfVariable(lang_info->arr, 16);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    TokenBufferClear(&state->tokens);
+    state->funcs_cnt = 0;
+
+    lang_info->token_buf = &state->tokens;
+
+    const char *ptr = state->source;
+    LexRange(lang_info, &ptr, state->source + state->size);
+    bool stopped = ptr < state->source + state->size;
+
+    size_t tokens_pos = 0;
+    lang_info->tokens_pos = &tokens_pos;
+
+    bool complete = false;
+    err = ParseFunctions(lang_info, state, state->tokens.size, &complete);
+    lang_info->token_buf = NULL;
+    if (err != kSuccess) {
+        return err;
+    }
+
+    state->dirty = stopped || !complete;
+
+    err = LinkFunctions(lang_info, state, 0);
+    if (err != kSuccess) {
+        return err;
+    }
+
+    return lang_info->root->root ? kSuccess : kFailure;
+}
+
+static size_t RelexDamaged(Language *lang_info, FrontState *state, size_t first, const SourceEdit *edit, TokenBuffer *damaged, bool *stopped) {
+    assert(lang_info);
+    assert(state);
+    assert(edit);
+    assert(damaged);
+    assert(stopped);
+
+    const char *src = state->source;
+    size_t begin = first ? state->funcs[first].offset : 0;
+    size_t next  = FindFunction(state, edit->offset + edit->removed);
+    const char *ptr = src + begin;
+
+    lang_info->token_buf = damaged;
+    *stopped = false;
+
+    while (true) {
+        size_t stop = next < state->funcs_cnt ? ShiftOffset(state->funcs[next].offset, edit) : state->size;
+
+        if (ptr < src + stop) {
+            size_t base = (size_t)(ptr - src);
+            size_t from = damaged->size;
+
+            LexRange(lang_info, &ptr, src + stop);
+            for (size_t i = from; i < damaged->size; i++) {
+                damaged->offset[i] += (uint32_t)base;
+            }
+
+            if (ptr < src + stop) {
+                // The whole-file lexer gives up at the same byte.
+                *stopped = true;
+                next = state->funcs_cnt;
+                break;
+            }
+        }
+
+        if (next == state->funcs_cnt) {
+            break;
+        }
+
+        if (ptr == src + stop) {
+            size_t gap = damaged->size ? damaged->offset[damaged->size - 1] + TokenLength(lang_info, damaged, damaged->size - 1, src) : begin;
+            if (IsNextTokenAt(src, state->size, gap, stop)) {
+                break;
+            }
+
+            // A comment runs over the old function start, nothing behind it can be reused.
+            TokenBufferClear(damaged);
+            ptr = src + begin;
+            next = state->funcs_cnt;
+            continue;
+        }
+
+        while (next < state->funcs_cnt && ShiftOffset(state->funcs[next].offset, edit) < (size_t)(ptr - src)) {
+            next++;
+        }
+    }
+
+    lang_info->token_buf = NULL;
+    return next;
+}
+
+static bool IsNextTokenAt(const char *src, size_t size, size_t from, size_t stop) {
+    assert(src);
+
+    const char *ptr = src + from;
+    const char *end = src + size;
+
+    while (ptr < src + stop) {
+        ptr = SkipBlanks(ptr, end, NULL, NULL);
+        if (ptr + 1 < end && ptr[0] == '/' && ptr[1] == '/') {
+            ptr = SkipToLineEnd(ptr + 2, end);
+        } else if (ptr + 1 < end && ptr[0] == '/' && ptr[1] == '*') {
+            ptr = SkipBlockComment(ptr + 2, end, NULL, NULL);
+        } else {
+            break;
+        }
+    }
+
+    return ptr == src + stop;
+}
+
+static size_t TokenLength(Language *lang_info, const TokenBuffer *tokens, size_t pos, const char *src) {
+    assert(lang_info);
+    assert(tokens);
+    assert(src);
+
+    const char *token = src + tokens->offset[pos];
+
+    switch ((NodeTypes)tokens->type[pos]) {
+        case kOperation: {
+            const char *name = NAME_TYPES_TABLE[tokens->value[pos].operation].name_in_lang;
+            size_t len = strlen(name);
+            return strncmp(token, name, len) == 0 ? len : 1; // '-' stands for minuo too
+        }
+        case kVariable:
+            return strlen(lang_info->arr->var_array[tokens->value[pos].pos].variable_name);
+        case kNumber: {
+            double number = 0;
+            const char *end = ScanNumber(token, &number);
+            return end ? (size_t)(end - token) : 1;
+        }
+        case kBlock: // the lexers never emit blocks
+        default:
+            return 1;
+    }
+}
+
+static LangErrors ParseFunctions(Language *lang_info, FrontState *state, size_t end, bool *complete) {
+    assert(lang_info);
+    assert(state);
+    assert(complete);
+
+    *complete = false;
+
+    while (*lang_info->tokens_pos < end) {
+        size_t start = *lang_info->tokens_pos;
+
+        LangNode_t *node = GetFunctionDeclare(lang_info);
+        if (!node) {
+            *lang_info->tokens_pos = start;
+            return kSuccess;
+        }
+
+        LangErrors err = ReserveFunctions(state, state->funcs_cnt + 1);
+        if (err != kSuccess) {
+            return err;
+        }
+
+        state->funcs[state->funcs_cnt++] = (FrontFunction){ .offset = lang_info->token_buf->offset[start], .token = start, .node = node };
+    }
+
+    *complete = (*lang_info->tokens_pos == end);
+    return kSuccess;
+}
+
+// Functions before `from` kept their place, the block is refilled from there on.
+static LangErrors LinkFunctions(Language *lang_info, FrontState *state, size_t from) {
+    assert(lang_info);
+    assert(state);
+
+    if (!state->program) {
+        state->program = NewBlock(lang_info);
+        if (!state->program) {
+            return kNoMemory;
+        }
+    }
+
+    NodeList *list = state->program->value.block;
+    if (from < list->size) {
+        list->size = from;
+    }
+
+    for (size_t i = list->size; i < state->funcs_cnt; i++) {
+        LangErrors err = BlockAppend(state->program, state->funcs[i].node);
+        if (err != kSuccess) {
+            return err;
+        }
+    }
+
+    lang_info->root->root = (state->funcs_cnt > 0) ? state->program : NULL;
+
+    return kSuccess;
+}
+
+static LangErrors ReserveFunctions(FrontState *state, size_t capacity) {
+    assert(state);
+
+    if (capacity <= state->capacity) {
+        return kSuccess;
+    }
+
+    size_t new_capacity = state->capacity ? state->capacity : 16;
+    while (new_capacity < capacity) {
+        new_capacity *= 2;
+    }
+
+    FrontFunction *new_funcs = (FrontFunction *) realloc (state->funcs, new_capacity * sizeof(FrontFunction));
+    if (!new_funcs) {
+        return kNoMemory;
+    }
+    state->funcs = new_funcs;
+
+    state->capacity = new_capacity;
+    return kSuccess;
+}
+
+static size_t FindFunction(const FrontState *state, size_t offset) {
+    assert(state);
+
+    size_t left = 0;
+    size_t right = state->funcs_cnt;
+
+    while (left < right) {
+        size_t mid = left + (right - left) / 2;
+        if (state->funcs[mid].offset < offset) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+
+    return left;
+}
+
+static size_t ShiftOffset(size_t offset, const SourceEdit *edit) {
+    assert(edit);
+
+    return offset - edit->removed + edit->inserted;
+}
+
+static void ReleaseOwnedVariables(VariableArr *arr, size_t func_pos) {
+    assert(arr);
+
+    const char *name = arr->var_array[func_pos].variable_name;
+
+    for (size_t i = 0; i < arr->size; i++) {
+        if (arr->var_array[i].func_made && strcmp(arr->var_array[i].func_made, name) == 0) {
+            free(arr->var_array[i].func_made);
+            arr->var_array[i].func_made = NULL;
+        }
+    }
+}
+
+// Function names are mentioned by their declaration and by calls, the only places
+// where a name is followed by '('.
+static void MarkMentions(const TokenBuffer *tokens, size_t from, size_t to, unsigned char *mentions, Mention mention) {
+    assert(tokens);
+    assert(mentions);
+
+    for (size_t i = from; i < to; i++) {
+        if (tokens->type[i] == kVariable && (IsTokenOperation(tokens, i + 1, kOperationParOpen)
+                || (i > 0 && IsTokenOperation(tokens, i - 1, kOperationFunction)))) {
+            mentions[tokens->value[i].pos] |= mention;
+        }
+    }
+}
+
+static LangErrors SpliceSource(FrontState *state, const SourceEdit *edit) {
+    assert(state);
+    assert(edit);
+
+    size_t new_size = state->size - edit->removed + edit->inserted;
+    if (new_size > state->size) {
+        char *new_source = (char *) realloc (state->source, new_size + 1);
+        if (!new_source) {
+            return kNoMemory;
+        }
+        state->source = new_source;
+    }
+
+    size_t tail = edit->offset + edit->removed;
+    memmove(state->source + edit->offset + edit->inserted, state->source + tail, state->size - tail + 1);
+    if (edit->inserted) {
+        memcpy(state->source + edit->offset, edit->text, edit->inserted);
+    }
+    state->size = new_size;
+
+    return kSuccess;
+}
+
+/* G :: = FUNCTION_D+
+   OP :: = WHILE | IF | ASSIGNMENT+; | FUNCTION_C
+   WHILE :: = 'while' ( E ) { OP+ }
+   IF :: = 'if' ( E ) { OP+ }
+   ASSIGNMENT :: = V '=' E
+   FUNCTION_D :: = "declare" V (T {, T}+) { OP+}
+   FUNCTION_C :: = V (T {, T}+);
+   E :: = T ([+-] T)*
+   T :: = POWER ([*:] T)*
+   POWER :: = PRIMARY ([^] POWER)*
+   PRIMARY :: = ( E ) | N | S
+*/
+
+static LangNode_t *GetGoal(Language *lang_info) { //
+    assert(lang_info);
+
+    CHECK_NULL_RETURN(program, NewBlock(lang_info));
+    do {
+        LangNode_t *next = GetFunctionDeclare(lang_info);
+        if (!next) break;
+
+        if (BlockAppend(program, next) != kSuccess) {
+            return NULL;
+        }
+    } while (true);
+
+    return program->value.block->size ? program : NULL;
+}
+
+// Only the functions MAIN can reach are parsed. Reaching goes over tokens: every name
+// inside a reached function that some `incantatio` declares reaches that function too,
+// so calls, addresses and even locals of the same name keep a function alive.
+static LangNode_t *GetReachableGoal(Language *lang_info) {
+    assert(lang_info);
+
+    const TokenBuffer *tokens = lang_info->token_buf;
+    const VariableInfo *vars  = lang_info->arr->var_array;
+
+    size_t funcs_cnt = 0;
+    for (size_t i = 0; i < tokens->size; i++) {
+        if (IS_TOKEN_OP(i, kOperationFunction) && IS_TOKEN_TYPE(i + 1, kVariable)) {
+            funcs_cnt++;
+        }
+    }
+
+    LazyFunction *funcs = (LazyFunction *) calloc (funcs_cnt + 1, sizeof(LazyFunction));
+    size_t *first = (size_t *) calloc (lang_info->arr->size + 1, sizeof(size_t));
+    size_t *queue = (size_t *) calloc (funcs_cnt + 1, sizeof(size_t));
+    if (!funcs || !first || !queue) {
+        free(funcs);
+        free(first);
+        free(queue);
+        return NULL;
+    }
+
+    size_t cnt = 0;
+    for (size_t i = 0; i < tokens->size; i++) {
+        if (IS_TOKEN_OP(i, kOperationFunction) && IS_TOKEN_TYPE(i + 1, kVariable)) {
+            if (cnt) {
+                funcs[cnt - 1].end = i;
+            }
+            funcs[cnt++] = (LazyFunction){ .token = i, .end = tokens->size, .name = TOKEN_VAR_POS(i + 1) };
+        }
+    }
+
+    for (size_t i = funcs_cnt; i > 0; i--) {
+        funcs[i - 1].next = first[funcs[i - 1].name];
+        first[funcs[i - 1].name] = i;
+    }
+
+    size_t queue_size = 0;
+    for (size_t i = 0; i < funcs_cnt; i++) {
+        if (strcmp(vars[funcs[i].name].variable_name, MAIN) == 0) {
+            ReachFunctions(funcs, first, funcs[i].name, queue, &queue_size);
+            break;
+        }
+    }
+
+    for (size_t head = 0; head < queue_size; head++) {
+        const LazyFunction *func = &funcs[queue[head]];
+        for (size_t i = func->token + 2; i < func->end; i++) {
+            if (IS_TOKEN_TYPE(i, kVariable)) {
+                ReachFunctions(funcs, first, TOKEN_VAR_POS(i), queue, &queue_size);
+            }
+        }
+    }
+
+    // Source order keeps the tree the same as a full parse without the dead functions.
+    LangNode_t *program = queue_size ? NewBlock(lang_info) : NULL;
+    for (size_t i = 0; i < funcs_cnt && program; i++) {
+        if (!funcs[i].reached) {
+            continue;
+        }
+
+        *lang_info->tokens_pos = funcs[i].token;
+        LangNode_t *next = GetFunctionDeclare(lang_info);
+        if (!next || BlockAppend(program, next) != kSuccess) {
+            program = NULL;
+        }
+    }
+
+    if (queue_size == 0) {
+        fprintf(stderr, "No %s to start parsing from.\n", MAIN);
+    }
+
+    free(funcs);
+    free(first);
+    free(queue);
+
+    return program;
+}
+
+static void ReachFunctions(LazyFunction *funcs, const size_t *first, size_t name, size_t *queue, size_t *queue_size) {
+    assert(funcs);
+    assert(first);
+    assert(queue);
+    assert(queue_size);
+
+    for (size_t i = first[name]; i; i = funcs[i - 1].next) {
+        if (!funcs[i - 1].reached) {
+            funcs[i - 1].reached = true;
+            queue[(*queue_size)++] = i - 1;
+        }
+    }
+}
+
+// Tasks are runs of whole functions parsed on their own threads, each against a private
+// copy of the name table as it was before parsing. The merge walks them in source order
+// and takes a task only if the table it read agrees with what the functions before it
+// made of the shared one; any other task is parsed again right there, so the tree is the
+// one GetGoal builds. Workers report syntax errors themselves, also ones a sequential
+// parse would not reach.
+static LangNode_t *GetGoalParallel(Language *lang_info) {
+    assert(lang_info);
+    assert(lang_info->token_buf);
+
+    size_t threads = lang_info->parse_threads;
+
+    ParseTask *tasks = NULL;
+    size_t tasks_cnt = 0;
+    if (SplitParseTasks(lang_info->token_buf, threads * PARSE_TASKS_PER_THREAD, &tasks, &tasks_cnt) != kSuccess) {
+        return NULL;
+    }
+
+    VariableArr names = {};
+    pthread_t *workers = (pthread_t *) calloc (threads, sizeof(pthread_t));
+    bool *started = (bool *) calloc (threads, sizeof(bool));
+    if (!workers || !started || CopyVariables(&names, lang_info->arr) != kSuccess) {
+        free(tasks);
+        free(workers);
+        free(started);
+        return NULL;
+    }
+
+    ParsePool pool = { .lang_info = lang_info, .names = &names, .tasks = tasks, .tasks_cnt = tasks_cnt, .next = 0, .lock = {} };
+    pthread_mutex_init(&pool.lock, NULL);
+
+    for (size_t i = 1; i < threads && i < tasks_cnt; i++) {
+        started[i] = pthread_create(&workers[i], NULL, ParseTaskWorker, &pool) == 0;
+    }
+    ParseTaskWorker(&pool);
+
+    for (size_t i = 1; i < threads; i++) {
+        if (started[i]) {
+            pthread_join(workers[i], NULL);
+        }
+    }
+    pthread_mutex_destroy(&pool.lock);
+
+    LangNode_t *program = NewBlock(lang_info);
+    bool going = program != NULL;
+    *lang_info->tokens_pos = 0;
+
+    for (size_t i = 0; i < tasks_cnt && going; i++) {
+        ParseTask *task = &tasks[i];
+
+        if (*lang_info->tokens_pos == task->begin && task->error == kSuccess && IsTaskValid(lang_info, &names, task)) {
+            NodeList *funcs = task->block->value.block;
+            for (size_t j = 0; j < funcs->size && program; j++) {
+                if (BlockAppend(program, funcs->items[j]) != kSuccess) {
+                    program = NULL;
+                }
+            }
+
+            ApplyTask(lang_info->arr, &names, task);
+            NodeArenaAdopt(&lang_info->root->arena, &task->root.arena);
+            lang_info->root->size += task->root.size;
+
+            *lang_info->tokens_pos = task->stop;
+            going = program && !task->failed;
+        } else {
+            going = ParseDeclarations(lang_info, program, task->end);
+        }
+    }
+
+    if (going) {
+        ParseDeclarations(lang_info, program, SIZE_MAX);
+    }
+
+    for (size_t i = 0; i < tasks_cnt; i++) {
+        if (lang_info->memo) {
+            lang_info->memo->lookups      += tasks[i].memo.lookups;
+            lang_info->memo->hits         += tasks[i].memo.hits;
+            lang_info->memo->tokens_saved += tasks[i].memo.tokens_saved;
+        }
+        ParseMemoDtor(&tasks[i].memo);
+        NodeArenaDtor(&tasks[i].root.arena);
+        DropVariables(&tasks[i].arr);
+    }
+    DropVariables(&names);
+    free(tasks);
+    free(workers);
+    free(started);
+
+    return program && program->value.block->size ? program : NULL;
+}
+
+// Functions start at `incantatio` outside of any body, every task gets about as many tokens.
+static LangErrors SplitParseTasks(const TokenBuffer *tokens, size_t parts, ParseTask **tasks, size_t *tasks_cnt) {
+    assert(tokens);
+    assert(tasks);
+    assert(tasks_cnt);
+
+    size_t funcs_cnt = 0;
+    size_t depth = 0;
+    for (size_t i = 0; i < tokens->size; i++) {
+        if (IsTokenOperation(tokens, i, kOperationBraceOpen)) {
+            depth++;
+        } else if (IsTokenOperation(tokens, i, kOperationBraceClose)) {
+            depth -= depth > 0;
+        } else if (depth == 0 && IsTokenOperation(tokens, i, kOperationFunction)) {
+            funcs_cnt++;
+        }
+    }
+
+    if (parts > funcs_cnt) {
+        parts = funcs_cnt;
+    }
+
+    *tasks_cnt = 0;
+    *tasks = (ParseTask *) calloc (parts + 1, sizeof(ParseTask));
+    if (!*tasks) {
+        return kNoMemory;
+    }
+
+    size_t target = parts ? tokens->size / parts : 0;
+    depth = 0;
+    for (size_t i = 0; i < tokens->size; i++) {
+        if (IsTokenOperation(tokens, i, kOperationBraceOpen)) {
+            depth++;
+        } else if (IsTokenOperation(tokens, i, kOperationBraceClose)) {
+            depth -= depth > 0;
+        } else if (depth == 0 && IsTokenOperation(tokens, i, kOperationFunction)) {
+            ParseTask *last = *tasks_cnt ? &(*tasks)[*tasks_cnt - 1] : NULL;
+            if (!last || (i - last->begin >= target && *tasks_cnt < parts)) {
+                if (last) {
+                    last->end = i;
+                }
+                (*tasks)[(*tasks_cnt)++].begin = i;
+            }
+        }
+    }
+
+    if (*tasks_cnt) {
+        (*tasks)[*tasks_cnt - 1].end = tokens->size;
+    }
 
-#define DEFINE_SIMPLE_COMMAND_PARSER(func_name, op_type)                \
-static LangNode_t *func_name(Language *lang_info) {                     \
-    assert(lang_info);                                                  \
-                                                                        \
-    size_t save_pos = *(lang_info->tokens_pos);                         \
-    LangNode_t *name = NULL, *tok = NULL;                               \
-                                                                        \
-    CHECK_EXPECTED_TOKEN(name, IsThatOperation(name, op_type), );       \
-    CHECK_EXPECTED_TOKEN(tok,  IsThatOperation(tok, kOperationThen), ); \
-                                                                        \
-    return name;                                                        \
+    return kSuccess;
 }
 
+static void *ParseTaskWorker(void *arg) {
+    assert(arg);
 
-static LangNode_t *GetGoal(Language *lang_info);
-static LangNode_t *GetAssignment(Language *lang_info, LangNode_t *func_name);
-static LangNode_t *GetOp(Language *lang_info, LangNode_t *func_name);
-static LangNode_t *GetStatementSequence(Language *lang_info, LangNode_t *func_name, size_t *save_pos);
-static LangNode_t *GetFunctionDeclare(Language *lang_info);
-static LangNode_t *GetFunctionCall(Language *lang_info);
+    ParsePool *pool = (ParsePool *)arg;
 
-static LangNode_t *GetWhile(Language *lang_info, LangNode_t *func_name);
-static LangNode_t *GetIf(Language *lang_info, LangNode_t *func_name);
-static LangNode_t *GetElse(Language *lang_info, LangNode_t *if_node, LangNode_t *func_name);
-static LangNode_t *GetCondition(Language *lang_info, LangNode_t *func_name);
-static LangNode_t *GetReturn(Language *lang_info, LangNode_t *func_name);
-static LangNode_t *GetPrintf(Language *lang_info);
-static LangNode_t *GetScanf(Language *lang_info, LangNode_t *func_name);
-static LangNode_t *GetUnaryFunc(Language *lang_info, LangNode_t *func_name);
-static LangNode_t *GetHLT(Language *lang_info);
-static LangNode_t *GetDraw(Language *lang_info);
-
-static LangNode_t *GetStatement(Language *lang_info, LangNode_t *func_name);
-static LangNode_t *GetExpression(Language *lang_info, LangNode_t *func_name);
-static LangNode_t *GetTerm(Language *lang_info, LangNode_t *func_name);
-static LangNode_t *GetPrimary(Language *lang_info, LangNode_t *func_name);
-static LangNode_t *GetPower(Language *lang_info, LangNode_t *func_name);
-static LangNode_t *GetTernary(Language *lang_info, LangNode_t *func_name);
-
-static LangNode_t *GetVariableAddr(Language *lang_info, LangNode_t *func_name, ValCategory mode);
-static LangNode_t *GetNumber(Language *lang_info);
-static LangNode_t *GetString(Language *lang_info, LangNode_t *func_name, ValCategory val_cat);
-static bool SyncFuncMade(VariableArr *arr, size_t var_pos, size_t func_pos, ValCategory val_cat);
-static LangNode_t *GetArrayElement(Language *lang_info, LangNode_t *func_name);
+    while (true) {
+        pthread_mutex_lock(&pool->lock);
+        size_t i = pool->next++;
+        pthread_mutex_unlock(&pool->lock);
 
-static LangNode_t *ParseFunctionArgs(Language *lang_info, size_t *cnt, LangNode_t *func_name);
-static LangNode_t *ParseBody(Language *lang_info, LangNode_t *func_name);
+        if (i >= pool->tasks_cnt) {
+            break;
+        }
 
-static LangNode_t *GetArrayAssignment(Language *lang_info, LangNode_t *func_name);
-static LangNode_t *GetAssignmentLValue(Language *lang_info, LangNode_t *func_name);
-static LangNode_t *ParseAssignmentRValue(Language *lang_info, LangNode_t *func_name, LangNode_t *lvalue);
-static LangNode_t *ParseAddrToken(Language *lang_info, LangNode_t *token);
-static bool CheckAndSetFunctionArgsNumber(Language *lang_info, LangNode_t *name_token, size_t cnt);
-static LangNode_t *CheckArrayPos(VariableArr *arr, LangNode_t *maybe_var, LangNode_t *number);
-static LangNode_t *ParseSimpleAssignment(Language *lang_info, LangNode_t *func_name);
-static bool CheckCompareSign(LangNode_t *sign);
-static void ConnectParentAndChild(LangNode_t *parent, LangNode_t *child, ChildNode node_type);
+        RunParseTask(pool, &pool->tasks[i]);
+    }
 
-LangErrors ReadInfix(Language *lang_info, DumpInfo *dump_info, const char *filename) {
-    assert(lang_info);
-    assert(dump_info);
-    assert(filename);
+    return NULL;
+}
 
-    FILE_OPEN_AND_CHECK(file, filename, "r", NULL, NULL, NULL);
+static void RunParseTask(const ParsePool *pool, ParseTask *task) {
+    assert(pool);
+    assert(task);
 
-    FileInfo Info = {};
-    DoBufRead(file, filename, &Info);
-    fclose(file);
+    size_t tokens_pos = task->begin;
 
-    const char *temp_buf_ptr = Info.buf_ptr;
-    CheckAndReturn(lang_info, &temp_buf_ptr);
-    free(Info.buf_ptr);
+    Language lang_info = *pool->lang_info;
+    lang_info.root       = &task->root;
+    lang_info.arr        = &task->arr;
+    lang_info.tokens_pos = &tokens_pos;
+    lang_info.memo       = NULL;
 
-    size_t tokens_pos = 0;
-    lang_info->tokens_pos = &tokens_pos;
+    task->error = CopyVariables(&task->arr, pool->names);
+    if (task->error == kSuccess && pool->lang_info->memo) {
+        task->error = ParseMemoCtor(&task->memo, 0);
+        lang_info.memo = &task->memo;
+    }
+    if (task->error != kSuccess) {
+        return;
+    }
 
-    lang_info->root->root = GetGoal(lang_info);
-    if (!lang_info->root->root) {
-        return kFailure;
+    task->block = NewBlock(&lang_info);
+    if (!task->block) {
+        task->error = kNoMemory;
+        return;
     }
-    
-    DoTreeInGraphviz(lang_info->root->root, dump_info, lang_info->arr);
 
-    return kSuccess;
+    while (tokens_pos < task->end) {
+        LangNode_t *node = GetFunctionDeclare(&lang_info);
+        if (!node) {
+            task->failed = true;
+            break;
+        }
+
+        if (BlockAppend(task->block, node) != kSuccess) {
+            task->error = kNoMemory;
+            break;
+        }
+    }
+
+    task->stop = tokens_pos;
 }
 
-#define NEWN(num) NewNode(lang_info, kNumber, ((Value){ .number = (num)}), NULL, NULL)
-#define NEWOP(op, left, right) NewNode(lang_info, kOperation, (Value){ .operation = (op) }, left, right) 
+// What the parser reads from other functions: parameter counts, sizes of arrays and,
+// for the function being parsed, who made a variable of its name. A task is wrong only
+// if the shared table moved away from the copy it started with where the task looked.
+static bool IsTaskValid(const Language *lang_info, const VariableArr *names, const ParseTask *task) {
+    assert(lang_info);
+    assert(names);
+    assert(task);
 
-/* G :: = FUNCTION_D+
-   OP :: = WHILE | IF | ASSIGNMENT+; | FUNCTION_C
-   WHILE :: = 'while' ( E ) { OP+ }
-   IF :: = 'if' ( E ) { OP+ }
-   ASSIGNMENT :: = V '=' E
-   FUNCTION_D :: = "declare" V (T {, T}+) { OP+}
-   FUNCTION_C :: = V (T {, T}+);
-   E :: = T ([+-] T)*
-   T :: = POWER ([*:] T)*
-   POWER :: = PRIMARY ([^] POWER)*
-   PRIMARY :: = ( E ) | N | S
-*/
+    const VariableInfo *before = names->var_array;
+    const VariableInfo *after  = task->arr.var_array;
+    const VariableInfo *now    = lang_info->arr->var_array;
 
-static LangNode_t *GetGoal(Language *lang_info) { //
+    size_t to = task->stop > task->end ? task->stop : task->end;
+    for (size_t i = task->begin; i < to; i++) {
+        if (IS_TOKEN_TYPE(i, kVariable) && IS_TOKEN_OP(i + 1, kOperationBracketOpen)
+                && now[TOKEN_VAR_POS(i)].variable_value != before[TOKEN_VAR_POS(i)].variable_value) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < names->size; i++) {
+        if (after[i].params_number != before[i].params_number && now[i].params_number != before[i].params_number
+                && after[i].params_number != now[i].params_number) {
+            return false;
+        }
+
+        if (after[i].type != before[i].type && (now[i].type != before[i].type || now[i].func_made || after[i].func_made)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void ApplyTask(VariableArr *arr, const VariableArr *names, ParseTask *task) {
+    assert(arr);
+    assert(names);
+    assert(task);
+
+    const VariableInfo *before = names->var_array;
+    VariableInfo *after = task->arr.var_array;
+    VariableInfo *now   = arr->var_array;
+
+    for (size_t i = 0; i < names->size; i++) {
+        if (after[i].params_number != before[i].params_number) {
+            now[i].params_number = after[i].params_number;
+        }
+        if (after[i].variable_value != before[i].variable_value) {
+            now[i].variable_value = after[i].variable_value;
+        }
+        if (after[i].type != before[i].type) {
+            now[i].type = after[i].type;
+        }
+        if (after[i].func_made && (!before[i].func_made || strcmp(after[i].func_made, before[i].func_made) != 0)) {
+            free(now[i].func_made);
+            now[i].func_made = after[i].func_made;
+            after[i].func_made = NULL;
+        }
+    }
+}
+
+static bool ParseDeclarations(Language *lang_info, LangNode_t *program, size_t end) {
     assert(lang_info);
+    assert(program);
 
-    LangNode_t *first = NULL;
-    do {
+    while (*lang_info->tokens_pos < end) {
         LangNode_t *next = GetFunctionDeclare(lang_info);
-        if (!next) break;
-        else if (!first) {
-            first = next;
-        } else if (first && !first->left) {
-            first->left = next;
-        } else if (first && !first->right) {
-            first->right = next;
-        } else {
-            first = NEWOP(kOperationThen, first, next);
+        if (!next || BlockAppend(program, next) != kSuccess) {
+            return false;
         }
-    } while (true);
+    }
+
+    return true;
+}
+
+// Names stay with `from`, the copy only owns what the parser may change.
+static LangErrors CopyVariables(VariableArr *to, const VariableArr *from) {
+    assert(to);
+    assert(from);
+
+    // Same capacity as the shared table, so a worker sees exactly what the serial parse sees.
+    to->var_array = (VariableInfo *) calloc (from->capacity, sizeof(VariableInfo));
+    if (!to->var_array) {
+        return kNoMemory;
+    }
+    to->size     = from->size;
+    to->capacity = from->capacity;
+
+    for (size_t i = 0; i < from->capacity; i++) {
+        to->var_array[i] = from->var_array[i];
+        to->var_array[i].func_made = NULL;
+
+        if (from->var_array[i].func_made) {
+            to->var_array[i].func_made = strdup(from->var_array[i].func_made);
+            if (!to->var_array[i].func_made) {
+                DropVariables(to);
+                return kNoMemory;
+            }
+        }
+    }
 
-    return first;
+    return kSuccess;
+}
+
+static void DropVariables(VariableArr *arr) {
+    assert(arr);
+
+    for (size_t i = 0; i < arr->size; i++) {
+        free(arr->var_array[i].func_made);
+    }
+    free(arr->var_array);
+
+    *arr = {};
 }
 
-static LangNode_t *GetReturn(Language *lang_info, LangNode_t *func_name) {
+static LangNode_t *GetReturn(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
     size_t save_pos = (*lang_info->tokens_pos);
-    LangNode_t *return_node = NULL;
-    CHECK_EXPECTED_TOKEN(return_node, IsThatOperation(return_node, kOperationReturn), );
+    size_t return_tok = 0;
+    CHECK_EXPECTED_TOKEN(return_tok, IS_TOKEN_OP(return_tok, kOperationReturn), );
 
-    CHECK_NULL_RETURN(node, GetExpression(lang_info, func_name));
+    CHECK_NULL_RETURN(node, GetExpression(lang_info, func_pos));
     (*lang_info->tokens_pos)++; 
 
+    CHECK_NULL_RETURN(return_node, NodeFromToken(lang_info, return_tok));
     ConnectParentAndChild(return_node, node, kleft);
     return return_node;
 }
 
-static LangNode_t *GetScanf(Language *lang_info, LangNode_t *func_name) {
+static LangNode_t *GetScanf(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
     size_t save_pos = (*lang_info->tokens_pos);
-    LangNode_t *read_node = NULL, *tok = NULL;
+    size_t read_tok = 0, tok = 0;
 
-    CHECK_EXPECTED_TOKEN(read_node, IsThatOperation(read_node, kOperationRead),);
-    CHECK_EXPECTED_TOKEN(tok, IsThatOperation(tok, kOperationParOpen), );
+    CHECK_EXPECTED_TOKEN(read_tok, IS_TOKEN_OP(read_tok, kOperationRead),);
+    CHECK_EXPECTED_TOKEN(tok, IS_TOKEN_OP(tok, kOperationParOpen), );
     
-    TRY_PARSE_FUNC_AND_RETURN_NULL(node, GetString(lang_info, func_name, krvalue), 
+    TRY_PARSE_FUNC_AND_RETURN_NULL(node, GetString(lang_info, func_pos, krvalue), 
         *(lang_info)->tokens_pos = (save_pos););
 
-    CHECK_EXPECTED_TOKEN(tok, IsThatOperation(tok, kOperationParClose), 
+    CHECK_EXPECTED_TOKEN(tok, IS_TOKEN_OP(tok, kOperationParClose), 
         fprintf(stderr, "SYNTAX_ERROR_SCANF: no closing par.\n"));
 
-    CHECK_EXPECTED_TOKEN(tok, IsThatOperation(tok, kOperationThen), 
+    CHECK_EXPECTED_TOKEN(tok, IS_TOKEN_OP(tok, kOperationThen), 
         fprintf(stderr, "SYNTAX_ERROR_SCANF: no ';'.\n"));
 
+    CHECK_NULL_RETURN(read_node, NodeFromToken(lang_info, read_tok));
     ConnectParentAndChild(read_node, node, kleft); 
     return read_node;
 }
 
-static LangNode_t *GetStatement(Language *lang_info, LangNode_t *func_name) {
+static LangNode_t *GetStatement(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
     size_t save_pos = *lang_info->tokens_pos;
-    LangNode_t *stmt = NULL;
-    TRY_PARSE_RETURN(stmt, GetAssignment(lang_info, func_name));
+    if (!IS_TOKEN_TYPE(save_pos, kVariable) || !IS_TOKEN_OP(save_pos + 1, kOperationParOpen)) {
+        return GetAssignment(lang_info, func_pos);
+    }
 
-    LangNode_t *func_call = GetFunctionCall(lang_info); // do not always need ';', f.e. in printf
-    if (func_call) {
-        LangNode_t *tok = NULL;
-        CHECK_EXPECTED_TOKEN(tok, IsThatOperation(tok, kOperationThen), 
-            fprintf(stderr, "SYNTAX_ERROR_STATEMENT: expected ';' after function call.\n"););
+    CHECK_NULL_RETURN(func_call, GetFunctionCall(lang_info)); // do not always need ';', f.e. in printf
 
-        return func_call;
-    }
-    
-    return NULL;
+    size_t tok = 0;
+    CHECK_EXPECTED_TOKEN(tok, IS_TOKEN_OP(tok, kOperationThen), 
+        fprintf(stderr, "SYNTAX_ERROR_STATEMENT: expected ';' after function call.\n"););
+
+    return func_call;
 }
 
-static LangNode_t *GetOp(Language *lang_info, LangNode_t *func_name) {
+static LangNode_t *GetOp(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
-    LangNode_t *stmt = NULL;
     size_t save_pos = (*lang_info->tokens_pos);
 
-    TRY_PARSE_RETURN(stmt, GetReturn(lang_info, func_name));
-    TRY_PARSE_RETURN(stmt, GetPrintf(lang_info));
-    TRY_PARSE_RETURN(stmt, GetScanf(lang_info, func_name));
-    TRY_PARSE_RETURN(stmt, GetWhile (lang_info, func_name));
-    TRY_PARSE_RETURN(stmt, GetIf    (lang_info, func_name));
-    TRY_PARSE_RETURN(stmt, GetHLT   (lang_info));
-    TRY_PARSE_RETURN(stmt, GetDraw  (lang_info));
-
-    return GetStatementSequence(lang_info, func_name, &save_pos);
-}
-
-static LangNode_t *GetStatementSequence(Language *lang_info, LangNode_t *func_name, size_t *save_pos) {
-    assert(lang_info);
-    assert(func_name);
-    assert(save_pos);
+    if (IS_TOKEN_TYPE(save_pos, kOperation)) {
+        StatementParser parser = STATEMENT_DISPATCH.parser[lang_info->token_buf->value[save_pos].operation];
+        if (parser) {
+            LangNode_t *stmt = parser(lang_info, func_pos);
+            if (!stmt) {
+                *lang_info->tokens_pos = save_pos;
+            }
 
-    LangNode_t *seq = NULL;
-    while (true) {
-        *save_pos = *lang_info->tokens_pos;
-        
-        LangNode_t *stmt = GetStatement(lang_info, func_name);
-        if (!stmt) {
-            (*lang_info->tokens_pos) = *save_pos;
-            break;
+            return stmt;
         }
+    }
 
-        seq = (!seq) ? stmt : NEWOP(kOperationThen, seq, stmt);
-        
-        LangNode_t *tok = GetStackElem(lang_info->tokens, *(lang_info->tokens_pos));
-        if (!IsThatOperation(tok, kOperationThen)) {
-            break;
-        }
+    LangNode_t *stmt = GetStatement(lang_info, func_pos);
+    if (!stmt) {
+        *lang_info->tokens_pos = save_pos;
+        return NULL;
+    }
 
-        (*lang_info->tokens_pos)++; 
-    }   
+    if (IS_TOKEN_OP(*(lang_info->tokens_pos), kOperationThen)) {
+        (*lang_info->tokens_pos)++;
+    }
 
-    return seq;
+    return stmt;
 }
 
 #define NEWN(num) NewNode(lang_info, kNumber, ((Value){ .number = (num)}), NULL, NULL)
-#define NEWV(name) NewVariable(lang_info, name)
 #define ADD_(left, right) NewNode(root, kOperation, (Value){ .operation = kOperationAdd}, left, right)
 #define SUB_(left, right) NewNode(root, kOperation, (Value){ .operation = kOperationSub}, left, right)
 #define MUL_(left, right) NewNode(root, kOperation, (Value){ .operation = kOperationMul}, left, right)
 #define DIV_(left, right) NewNode(root, kOperation, (Value){ .operation = kOperationDiv}, left, right)
 #define POW_(left, right) NewNode(root, kOperation, (Value){ .operation = kOperationPow}, left, right)
 
-static LangNode_t *GetPrintf(Language *lang_info) {
+static LangNode_t *GetPrintf(Language *lang_info, size_t func_pos) {
     assert(lang_info);
+    (void)func_pos;
 
-    LangNode_t *print_node = GetStackElem(lang_info->tokens, *(lang_info->tokens_pos));
-    if (IsThatOperation(print_node, kOperationWrite) || IsThatOperation(print_node, kOperationWriteChar)) {
+    size_t print_tok = *(lang_info->tokens_pos);
+    if (IS_TOKEN_OP(print_tok, kOperationWrite) || IS_TOKEN_OP(print_tok, kOperationWriteChar)) {
         (*lang_info->tokens_pos)++;
 
         size_t save_pos = *(lang_info->tokens_pos);
-        LangNode_t *par = NULL, *printf_arg = NULL;
+        size_t par = 0, printf_arg = 0;
 
-        CHECK_EXPECTED_TOKEN(par, IsThatOperation(par, kOperationParOpen),);
-        CHECK_EXPECTED_TOKEN(printf_arg, printf_arg && (IsThisNodeType(printf_arg, kVariable) || IsThisNodeType(printf_arg, kNumber)),
+        CHECK_EXPECTED_TOKEN(par, IS_TOKEN_OP(par, kOperationParOpen),);
+        CHECK_EXPECTED_TOKEN(printf_arg, IS_TOKEN_TYPE(printf_arg, kVariable) || IS_TOKEN_TYPE(printf_arg, kNumber),
             fprintf(stderr, "NO AVAILABLE ARGUMENT FOR PRINTF WRITTEN.\n"););
-        CHECK_EXPECTED_TOKEN(par, IsThatOperation(par, kOperationParClose), );
+        CHECK_EXPECTED_TOKEN(par, IS_TOKEN_OP(par, kOperationParClose), );
 
-        ConnectParentAndChild(print_node, printf_arg, kleft);
+        CHECK_NULL_RETURN(print_node, NodeFromToken(lang_info, print_tok));
+        CHECK_NULL_RETURN(arg_node,   NodeFromToken(lang_info, printf_arg));
+        ConnectParentAndChild(print_node, arg_node, kleft);
         (*lang_info->tokens_pos)++; 
         return print_node;
     }
@@ -313,25 +1460,32 @@ static LangNode_t *GetPrintf(Language *lang_info) {
 
 static LangNode_t *GetFunctionDeclare(Language *lang_info) {
     assert(lang_info);
+
+    if (lang_info->memo) {
+        ParseMemoForget(lang_info->memo);
+    }
     
     size_t save_pos = *(lang_info->tokens_pos);
-    LangNode_t *func_node = NULL, *func_name = NULL;
+    size_t func_tok = 0, name_tok = 0;
     
-    CHECK_EXPECTED_TOKEN(func_node, IsThatOperation(func_node, kOperationFunction), );
-    CHECK_EXPECTED_TOKEN(func_name, IsThisNodeType(func_name, kVariable), );
+    CHECK_EXPECTED_TOKEN(func_tok, IS_TOKEN_OP(func_tok, kOperationFunction), );
+    CHECK_EXPECTED_TOKEN(name_tok, IS_TOKEN_TYPE(name_tok, kVariable), );
     
-    lang_info->arr->var_array[func_name->value.pos].type = kVarFunction;
+    size_t func_pos = TOKEN_VAR_POS(name_tok);
+    lang_info->arr->var_array[func_pos].type = kVarFunction;
     size_t cnt = 0;
-    LangNode_t *args_root = ParseFunctionArgs(lang_info, &cnt, func_name);
+    LangNode_t *args_root = ParseFunctionArgs(lang_info, &cnt, func_pos);
     save_pos = (*lang_info->tokens_pos);
 
-    if (!CheckAndSetFunctionArgsNumber(lang_info, func_name, cnt)) {
+    if (!CheckAndSetFunctionArgsNumber(lang_info, func_pos, cnt)) {
         return NULL;
     }
     
-    lang_info->arr->var_array[func_name->value.pos].variable_value = lang_info->arr->var_array[func_name->value.pos].params_number;
-    LangNode_t *body_root = ParseBody(lang_info, func_name);
+    lang_info->arr->var_array[func_pos].variable_value = lang_info->arr->var_array[func_pos].params_number;
+    LangNode_t *body_root = ParseBody(lang_info, func_pos);
 
+    CHECK_NULL_RETURN(func_node, NodeFromToken(lang_info, func_tok));
+    CHECK_NULL_RETURN(func_name, NodeFromToken(lang_info, name_tok));
     ConnectParentAndChild(func_node, func_name, kleft);
     func_node->right = NEWOP(kOperationThen, args_root, body_root);
     return func_node;
@@ -340,140 +1494,211 @@ static LangNode_t *GetFunctionDeclare(Language *lang_info) {
 static LangNode_t *GetFunctionCall(Language *lang_info) {
     assert(lang_info);
 
+    RETURN_MEMOIZED(kMemoFunctionCall, 0, ParseFunctionCall(lang_info));
+}
+
+static LangNode_t *ParseFunctionCall(Language *lang_info) {
+    assert(lang_info);
+
     size_t save_pos = *lang_info->tokens_pos;
-    LangNode_t *name_token = NULL;
-    CHECK_EXPECTED_TOKEN(name_token, IsThisNodeType(name_token, kVariable), );
+    size_t name_tok = 0;
+    CHECK_EXPECTED_TOKEN(name_tok, IS_TOKEN_TYPE(name_tok, kVariable), );
     save_pos++;
 
     size_t cnt = 0;
-    LangNode_t *args_root = ParseFunctionArgs(lang_info, &cnt, name_token);
+    LangNode_t *args_root = ParseFunctionArgs(lang_info, &cnt, TOKEN_VAR_POS(name_tok));
     if (save_pos >= *lang_info->tokens_pos) {
         return NULL;
     }
 
-    if (!CheckAndSetFunctionArgsNumber(lang_info, name_token, cnt)) {
+    if (!CheckAndSetFunctionArgsNumber(lang_info, TOKEN_VAR_POS(name_tok), cnt)) {
         return NULL;
     }
 
-    return NEWOP(kOperationCall, name_token, args_root);
+    CHECK_NULL_RETURN(name_node, NodeFromToken(lang_info, name_tok));
+    return NEWOP(kOperationCall, name_node, args_root);
 }
 
-static LangNode_t *GetExpression(Language *lang_info, LangNode_t *func_name) {
+static LangNode_t *GetExpression(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
-    CHECK_NULL_RETURN(val, GetTerm(lang_info, func_name));
+    RETURN_MEMOIZED(kMemoExpression, func_pos, ParseExpression(lang_info, func_pos));
+}
 
-    lang_info->root->size++;
-    LangNode_t *node = GetStackElem(lang_info->tokens, *(lang_info->tokens_pos));
+static LangNode_t *ParseExpression(Language *lang_info, size_t func_pos) {
+    assert(lang_info);
 
-    while (IsThatOperation(node, kOperationAdd) || IsThatOperation(node, kOperationSub)) {
-        (*lang_info->tokens_pos)++;
+    return ParseInfix(lang_info, func_pos, 0);
+}
+
+// Precedence climbing over the binding powers in NAME_TYPES_TABLE: an operator joins
+// the expression on its left while its left power is at least min_power, and its right
+// operand takes every operator that binds at least as tightly as its right power.
+// Operators waiting for their right operand and open parentheses sit on a stack instead
+// of the call stack, so a long right-associative chain or deep parentheses cost heap only.
+static LangNode_t *ParseInfix(Language *lang_info, size_t func_pos, unsigned char min_power) {
+    assert(lang_info);
+
+    InfixStack stack = {};
+    stack.frames   = stack.local;
+    stack.capacity = INFIX_LOCAL_FRAMES;
+
+    LangNode_t *left   = NULL;
+    LangNode_t *result = NULL;
+
+    while (true) {
+        size_t tok = *(lang_info->tokens_pos);
+
+        if (!left) {
+            if (IS_TOKEN_OP(tok, kOperationParOpen)) {
+                if (!InfixPush(&stack, NULL, tok, min_power)) {
+                    break;
+                }
+                (*lang_info->tokens_pos)++;
+                min_power = 0;
+                continue;
+            }
+
+            left = GetPrimary(lang_info, func_pos);
+            if (!left) {
+                break;
+            }
+            continue;
+        }
+
+        if (IS_TOKEN_TYPE(tok, kOperation)) {
+            const LangTable *op = &NAME_TYPES_TABLE[lang_info->token_buf->value[tok].operation];
+            if (op->left_power != 0 && op->left_power >= min_power) {
+                if (!InfixPush(&stack, left, tok, min_power)) {
+                    break;
+                }
+                (*lang_info->tokens_pos)++;
+                min_power = op->right_power;
+                left = NULL;
+                continue;
+            }
+        }
+
+        if (stack.size == 0) {
+            result = left;
+            break;
+        }
 
-        LangNode_t *val2 = GetTerm(lang_info, func_name);
-        if (!val2) {
-            return val;
+        InfixFrame top = stack.frames[--stack.size];
+        min_power = top.min_power;
+
+        if (!top.left) {
+            if (!IS_TOKEN_OP(tok, kOperationParClose)) {
+                fprintf(stderr, "SYNTAX_ERROR_P: expected ')'\n");
+                break;
+            }
+            (*lang_info->tokens_pos)++;
+            continue;
+        }
+
+        LangNode_t *node = NodeFromToken(lang_info, top.op_tok);
+        if (!node) {
+            break;
         }
+        ConnectParentAndChild(node, top.left, kleft);
+        ConnectParentAndChild(node, left, kright);
 
-        lang_info->root->size++;
-        ConnectParentAndChild(node, val, kleft);
-        ConnectParentAndChild(node, val2, kright);
+        left = FoldLiterals(lang_info, node);
+    }
 
-        val = node;
-        node = GetStackElem(lang_info->tokens, *(lang_info->tokens_pos));
+    if (stack.frames != stack.local) {
+        free(stack.frames);
     }
 
-    return val;
+    return result;
 }
 
-static LangNode_t *GetTerm(Language *lang_info, LangNode_t *func_name) {
-    assert(lang_info);
-    assert(func_name);
-
-    CHECK_NULL_RETURN(left, GetPower(lang_info, func_name));
+static bool InfixPush(InfixStack *stack, LangNode_t *left, size_t op_tok, unsigned char min_power) {
+    assert(stack);
 
-    lang_info->root->size++;
-    LangNode_t *node = GetStackElem(lang_info->tokens, *(lang_info->tokens_pos));
+    if (stack->size == stack->capacity) {
+        size_t new_capacity = stack->capacity * 2;
+        InfixFrame *new_frames = NULL;
 
-    while (IsThatOperation(node, kOperationMul) || IsThatOperation(node, kOperationDiv)) {
-        (*lang_info->tokens_pos)++; 
+        if (stack->frames == stack->local) {
+            new_frames = (InfixFrame *) calloc (new_capacity, sizeof(InfixFrame));
+            if (new_frames) {
+                memcpy(new_frames, stack->local, stack->size * sizeof(InfixFrame));
+            }
+        } else {
+            new_frames = (InfixFrame *) realloc (stack->frames, new_capacity * sizeof(InfixFrame));
+        }
 
-        LangNode_t *right = GetTerm(lang_info, func_name);
-        if (!right) {
-            return left;
+        if (!new_frames) {
+            fprintf(stderr, "No memory to parse the expression.\n");
+            return false;
         }
-        ConnectParentAndChild(node, left, kleft);
-        ConnectParentAndChild(node, right, kright);
 
-        left = node;
-        node = GetStackElem(lang_info->tokens, *(lang_info->tokens_pos));
+        stack->frames   = new_frames;
+        stack->capacity = new_capacity;
     }
 
-    return left;
+    stack->frames[stack->size++] = {left, op_tok, min_power};
+    return true;
 }
 
-static LangNode_t *GetPrimary(Language *lang_info, LangNode_t *func_name) {
+static LangNode_t *GetPrimary(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
-    CHECK_NULL_RETURN(node, GetStackElem(lang_info->tokens, *(lang_info->tokens_pos)));
-    
-    if (IsThatOperation(node, kOperationParOpen)) {
-        (*lang_info->tokens_pos)++; 
-        
-        CHECK_NULL_RETURN(val, GetExpression(lang_info, func_name));
-        
-        size_t save_pos = (*lang_info->tokens_pos); 
-        CHECK_EXPECTED_TOKEN(node, IsThatOperation(node, kOperationParClose), 
-            fprintf(stderr, "SYNTAX_ERROR_P: expected ')'\n"););
-        
-        return val;
+    if (*(lang_info->tokens_pos) >= lang_info->token_buf->size) {
+        return NULL;
     }
-    
+
+    // Parentheses are taken by ParseInfix.
     size_t save_pos = *lang_info->tokens_pos;
     LangNode_t *value = NULL;
 
     TRY_PARSE_RETURN(value, GetNumber(lang_info));
     TRY_PARSE_RETURN(value, GetFunctionCall(lang_info));
-    TRY_PARSE_RETURN(value, GetUnaryFunc(lang_info, func_name));
-    TRY_PARSE_RETURN(value, GetArrayElement(lang_info, func_name));
-    TRY_PARSE_RETURN(value, GetVariableAddr(lang_info, func_name, krvalue));
+    TRY_PARSE_RETURN(value, GetUnaryFunc(lang_info, func_pos));
+    TRY_PARSE_RETURN(value, GetArrayElement(lang_info, func_pos));
+    TRY_PARSE_RETURN(value, GetVariableAddr(lang_info, func_pos, krvalue));
     
-    return GetString(lang_info, func_name, krvalue);
+    return GetString(lang_info, func_pos, krvalue);
 }
 
-static LangNode_t *GetUnaryFunc(Language *lang_info, LangNode_t *func_name) {
+static LangNode_t *GetUnaryFunc(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
-    LangNode_t *unary_func_name = NULL;
+    size_t unary_tok = 0;
     size_t save_pos = *lang_info->tokens_pos;
-    CHECK_EXPECTED_TOKEN(unary_func_name, IsThatOperation(unary_func_name, kOperationSQRT),);
+    CHECK_EXPECTED_TOKEN(unary_tok, IS_TOKEN_OP(unary_tok, kOperationSQRT),);
     
-    LangNode_t *par = NULL;
-    CHECK_EXPECTED_TOKEN(par, IsThatOperation(par, kOperationParOpen),);
+    size_t par = 0;
+    CHECK_EXPECTED_TOKEN(par, IS_TOKEN_OP(par, kOperationParOpen),);
     
-    TRY_PARSE_FUNC_AND_RETURN_NULL(value, GetExpression(lang_info, func_name), 
+    TRY_PARSE_FUNC_AND_RETURN_NULL(value, GetExpression(lang_info, func_pos), 
         fprintf(stderr, "SYNTAX_ERROR_UNARY\n"););
     
-    CHECK_EXPECTED_TOKEN(par, IsThatOperation(par, kOperationParClose),);
+    CHECK_EXPECTED_TOKEN(par, IS_TOKEN_OP(par, kOperationParClose),);
+
+    CHECK_NULL_RETURN(unary_func_name, NodeFromToken(lang_info, unary_tok));
     ConnectParentAndChild(unary_func_name, value, kleft);
 
-    return unary_func_name;
+    return FoldLiterals(lang_info, unary_func_name);
 }
 
-LangNode_t *GetAssignment(Language *lang_info, LangNode_t *func_name) {
+LangNode_t *GetAssignment(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
     size_t save_pos = *lang_info->tokens_pos;
     LangNode_t *value = NULL;
 
-    TRY_PARSE_RETURN(value, GetArrayAssignment(lang_info, func_name));
-    TRY_PARSE_RETURN(value, GetTernary(lang_info, func_name));
+    if (IS_TOKEN_OP(save_pos, kOperationArrDecl)
+            || (IS_TOKEN_TYPE(save_pos, kVariable) && IS_TOKEN_OP(save_pos + 1, kOperationBracketOpen))) {
+        TRY_PARSE_RETURN(value, GetArrayAssignment(lang_info, func_pos));
+        return NULL;
+    }
+
+    TRY_PARSE_RETURN(value, GetTernary(lang_info, func_pos));
 
     if (!value) {
-        value = ParseSimpleAssignment(lang_info, func_name);
+        value = ParseSimpleAssignment(lang_info, func_pos);
     }
 
     if (!value) {
@@ -483,21 +1708,21 @@ LangNode_t *GetAssignment(Language *lang_info, LangNode_t *func_name) {
 
     return value;
 }
-static LangNode_t *GetIf(Language *lang_info, LangNode_t *func_name) {
+static LangNode_t *GetIf(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
     size_t save_pos = *lang_info->tokens_pos;
-    LangNode_t *if_node = NULL;
+    size_t if_tok = 0;
 
-    CHECK_EXPECTED_TOKEN(if_node, IsThatOperation(if_node, kOperationIf),);
-    CHECK_NULL_RETURN(cond, GetCondition(lang_info, func_name));
+    CHECK_EXPECTED_TOKEN(if_tok, IS_TOKEN_OP(if_tok, kOperationIf),);
+    CHECK_NULL_RETURN(cond, GetCondition(lang_info, func_pos));
 
-    LangNode_t *last = ParseBody(lang_info, func_name);
+    CHECK_NULL_RETURN(last, ParseBody(lang_info, func_pos));
+    CHECK_NULL_RETURN(if_node, NodeFromToken(lang_info, if_tok));
     ConnectParentAndChild(if_node, cond, kleft);
     ConnectParentAndChild(if_node, last, kright);
 
-    LangNode_t *else_node = GetElse(lang_info, last, func_name);
+    LangNode_t *else_node = GetElse(lang_info, last, func_pos);
     if (else_node) {
         ConnectParentAndChild(if_node, else_node, kright);
     }
@@ -505,17 +1730,17 @@ static LangNode_t *GetIf(Language *lang_info, LangNode_t *func_name) {
     return if_node;
 }
 
-static LangNode_t *GetElse(Language *lang_info, LangNode_t *if_node, LangNode_t *func_name) {
+static LangNode_t *GetElse(Language *lang_info, LangNode_t *if_node, size_t func_pos) {
     assert(lang_info);
     assert(if_node);
-    assert(func_name);
 
     size_t save_pos = *lang_info->tokens_pos;
-    LangNode_t *node = NULL;
+    size_t else_tok = 0;
 
-    CHECK_EXPECTED_TOKEN(node, IsThatOperation(node, kOperationElse), );
-    CHECK_NULL_RETURN(last, ParseBody(lang_info, func_name));
+    CHECK_EXPECTED_TOKEN(else_tok, IS_TOKEN_OP(else_tok, kOperationElse), );
+    CHECK_NULL_RETURN(last, ParseBody(lang_info, func_pos));
 
+    CHECK_NULL_RETURN(node, NodeFromToken(lang_info, else_tok));
     ConnectParentAndChild(node, if_node, kleft);
     ConnectParentAndChild(node, last, kright);
     lang_info->root->size++;
@@ -523,87 +1748,64 @@ static LangNode_t *GetElse(Language *lang_info, LangNode_t *if_node, LangNode_t
     return node;
 }
 
-static LangNode_t *GetCondition(Language *lang_info, LangNode_t *func_name) {
+static LangNode_t *GetCondition(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
     size_t save_pos = *lang_info->tokens_pos;
-    LangNode_t *tok = NULL;
+    size_t tok = 0;
 
-    CHECK_EXPECTED_TOKEN(tok, IsThatOperation(tok, kOperationParOpen),
+    CHECK_EXPECTED_TOKEN(tok, IS_TOKEN_OP(tok, kOperationParOpen),
         fprintf(stderr, "%s", "SYNTAX_ERROR_IF/WHILE: expected '('\n"));
     
-    TRY_PARSE_FUNC_AND_RETURN_NULL(cond, GetExpression(lang_info, func_name),
+    TRY_PARSE_FUNC_AND_RETURN_NULL(cond, GetExpression(lang_info, func_pos),
         fprintf(stderr, "SYNTAX_ERROR_IF/WHILE: expected condition\n"););
 
-    LangNode_t *sign = GetStackElem(lang_info->tokens, *(lang_info->tokens_pos));
-    if (CheckCompareSign(sign)) {
+    size_t sign_tok = *(lang_info->tokens_pos);
+    if (CheckCompareSign(lang_info->token_buf, sign_tok)) {
         (*lang_info->tokens_pos)++;
-        TRY_PARSE_FUNC_AND_RETURN_NULL(number, GetExpression(lang_info, func_name), 
+        TRY_PARSE_FUNC_AND_RETURN_NULL(number, GetExpression(lang_info, func_pos), 
             fprintf(stderr, "SYNTAX_ERROR_IF/WHILE: no expression in if written.\n"););
 
+        CHECK_NULL_RETURN(sign, NodeFromToken(lang_info, sign_tok));
         ConnectParentAndChild(sign, cond, kleft);
         ConnectParentAndChild(sign, number, kright);
         cond = sign;
     }
 
-    CHECK_EXPECTED_TOKEN(tok, IsThatOperation(tok, kOperationParClose),
+    CHECK_EXPECTED_TOKEN(tok, IS_TOKEN_OP(tok, kOperationParClose),
         fprintf(stderr, "%s", "SYNTAX_ERROR_IF: expected ')'\n"));
     
     return cond;
 }
 
-static LangNode_t *GetWhile(Language *lang_info, LangNode_t *func_name) {
+static LangNode_t *GetWhile(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
     size_t save_pos = *(lang_info->tokens_pos);
-    LangNode_t *tok = NULL;
+    size_t while_tok = 0;
 
-    CHECK_EXPECTED_TOKEN(tok, IsThatOperation(tok, kOperationWhile), );
-    CHECK_NULL_RETURN(cond, GetCondition(lang_info, func_name));
-    CHECK_NULL_RETURN(body, ParseBody(lang_info, func_name));
+    CHECK_EXPECTED_TOKEN(while_tok, IS_TOKEN_OP(while_tok, kOperationWhile), );
+    CHECK_NULL_RETURN(cond, GetCondition(lang_info, func_pos));
+    CHECK_NULL_RETURN(body, ParseBody(lang_info, func_pos));
 
+    CHECK_NULL_RETURN(tok, NodeFromToken(lang_info, while_tok));
     ConnectParentAndChild(tok, cond, kleft);
     ConnectParentAndChild(tok, body, kright);
     return tok;
 }
 
-LangNode_t *GetPower(Language *lang_info, LangNode_t *func_name) {
-    assert(lang_info);
-    assert(func_name);
-
-    CHECK_NULL_RETURN(val, GetPrimary(lang_info, func_name));
-
-    LangNode_t *node = GetStackElem(lang_info->tokens, *(lang_info->tokens_pos));
-    while (IsThatOperation(node, kOperationPow)) {
-        (*(lang_info->tokens_pos))++;
-        CHECK_NULL_RETURN(val2, GetPower(lang_info, func_name));
-
-        // node->type = kOperation;
-        // node->value.operation = kOperationPow;
-        ConnectParentAndChild(node, val, kleft);
-        ConnectParentAndChild(node, val2, kright);
-
-        val = node;
-        node = GetStackElem(lang_info->tokens, *(lang_info->tokens_pos));
-    }
-
-    return val;
-}
-
-static LangNode_t *GetVariableAddr(Language *lang_info, LangNode_t *func_name, ValCategory mode) {
+static LangNode_t *GetVariableAddr(Language *lang_info, size_t func_pos, ValCategory mode) {
     assert(lang_info);
-    assert(func_name);
 
     size_t save_pos = *lang_info->tokens_pos;
-    LangNode_t *addr_node = NULL;
+    size_t addr_tok = 0;
 
-    CHECK_EXPECTED_TOKEN(addr_node, IsThatOperation(addr_node, kOperationCallAddr) || IsThatOperation(addr_node, kOperationGetAddr), );
+    CHECK_EXPECTED_TOKEN(addr_tok, IS_TOKEN_OP(addr_tok, kOperationCallAddr) || IS_TOKEN_OP(addr_tok, kOperationGetAddr), );
 
-    TRY_PARSE_FUNC_AND_RETURN_NULL(value, GetString(lang_info, func_name, mode), 
+    TRY_PARSE_FUNC_AND_RETURN_NULL(value, GetString(lang_info, func_pos, mode), 
         fprintf(stderr, "SYNTAX_ERROR_ADDR: wrong/no variable after addr sign.\n"););
     
+    CHECK_NULL_RETURN(addr_node, NodeFromToken(lang_info, addr_tok));
     ConnectParentAndChild(addr_node, value, kleft);
     return addr_node;
 }
@@ -611,40 +1813,46 @@ static LangNode_t *GetVariableAddr(Language *lang_info, LangNode_t *func_name, V
 static LangNode_t *GetNumber(Language *lang_info) {
     assert(lang_info);
 
-    LangNode_t *node = GetStackElem(lang_info->tokens, *(lang_info->tokens_pos));
+    size_t number_tok = *(lang_info->tokens_pos);
 
-    if (IsThisNodeType(node, kNumber)) {
+    if (IS_TOKEN_TYPE(number_tok, kNumber)) {
         (*(lang_info->tokens_pos))++;
-        return node;
+        return NodeFromToken(lang_info, number_tok);
     }
 
     return NULL;
 }
 
-static LangNode_t *GetString(Language *lang_info, LangNode_t *func_name, ValCategory val_cat) {
+static LangNode_t *GetString(Language *lang_info, size_t func_pos, ValCategory val_cat) {
+    assert(lang_info);
+
+    size_t var_tok = 0;
+    if (!MatchString(lang_info, func_pos, val_cat, &var_tok)) {
+        return NULL;
+    }
+
+    return NodeFromToken(lang_info, var_tok);
+}
+
+static bool MatchString(Language *lang_info, size_t func_pos, ValCategory val_cat, size_t *token) {
     assert(lang_info);
-    assert(func_name);
+    assert(token);
 
-    LangNode_t *node = GetStackElem(lang_info->tokens, *(lang_info->tokens_pos));
-    if (IsThisNodeType(node, kVariable)) {
+    *token = *(lang_info->tokens_pos);
+    if (IS_TOKEN_TYPE(*token, kVariable)) {
         (*(lang_info->tokens_pos))++;
     } else {
-        return NULL;
+        return false;
     }
 
-    size_t var_pos = node->value.pos;
-    size_t func_pos = func_name->value.pos;
+    size_t var_pos = TOKEN_VAR_POS(*token);
 
     if (var_pos >= lang_info->arr->size || func_pos >= lang_info->arr->size) {
         fprintf(stderr, "SYNTAX_ERROR_STRING: invalid variable position %zu %zu\n", var_pos, func_pos);
-        return NULL;
-    }
-
-    if (!SyncFuncMade(lang_info->arr, var_pos, func_pos, val_cat)) {
-        return NULL;
+        return false;
     }
 
-    return node;
+    return SyncFuncMade(lang_info->arr, var_pos, func_pos, val_cat);
 }
 
 static bool SyncFuncMade(VariableArr *arr, size_t var_pos, size_t func_pos, ValCategory val_cat) {
@@ -674,29 +1882,29 @@ static bool SyncFuncMade(VariableArr *arr, size_t var_pos, size_t func_pos, ValC
     return true;
 }
 
-static LangNode_t *GetTernary(Language *lang_info, LangNode_t *func_name) {
+static LangNode_t *GetTernary(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
     
     size_t save_pos = *lang_info->tokens_pos;
     
-    CHECK_NULL_RETURN(assign_op, GetAssignmentLValue(lang_info, func_name));
-    CHECK_NULL_RETURN(condition, GetExpression(lang_info, func_name));
+    CHECK_NULL_RETURN(assign_op, GetAssignmentLValue(lang_info, func_pos));
+    CHECK_NULL_RETURN(condition, GetExpression(lang_info, func_pos));
     
-    LangNode_t *question_tok = NULL;
-    CHECK_EXPECTED_TOKEN(question_tok, IsThatOperation(question_tok, kOperationTrueSeparator), );
+    size_t question_tok = 0;
+    CHECK_EXPECTED_TOKEN(question_tok, IS_TOKEN_OP(question_tok, kOperationTrueSeparator), );
     
-    TRY_PARSE_FUNC_AND_RETURN_NULL(true_expr, GetExpression(lang_info, func_name),
+    TRY_PARSE_FUNC_AND_RETURN_NULL(true_expr, GetExpression(lang_info, func_pos),
         fprintf(stderr, "SYNTAX_ERROR_TERNARY: expected expression after '?'\n"); *lang_info->tokens_pos = save_pos;);
     
-    LangNode_t *colon_tok = NULL;
-    CHECK_EXPECTED_TOKEN(colon_tok, IsThatOperation(colon_tok, kOperationFalseSeparator), 
+    size_t colon_tok = 0;
+    CHECK_EXPECTED_TOKEN(colon_tok, IS_TOKEN_OP(colon_tok, kOperationFalseSeparator), 
         fprintf(stderr, "SYNTAX_ERROR_TERNARY: expected ':' after true expression\n"));
     
-    TRY_PARSE_FUNC_AND_RETURN_NULL(false_expr, GetExpression(lang_info, func_name), 
+    TRY_PARSE_FUNC_AND_RETURN_NULL(false_expr, GetExpression(lang_info, func_pos), 
         fprintf(stderr, "SYNTAX_ERROR_TERNARY: expected expression after ':'\n"); *lang_info->tokens_pos = save_pos;);
     
-    LangNode_t *if_compare_node = NEWOP(kOperationE, NEWV(lang_info->arr->var_array[assign_op->left->value.pos].variable_name), condition);
+    LangNode_t *compare_var = NewNode(lang_info, kVariable, assign_op->left->value, NULL, NULL);
+    LangNode_t *if_compare_node = NEWOP(kOperationE, compare_var, condition);
     LangNode_t *ternary_root = NEWOP(kOperationTernary, assign_op, NULL);
     LangNode_t *else_node = NEWOP(kOperationElse, true_expr, false_expr);
     LangNode_t *if_node = NEWOP(kOperationIf, if_compare_node, else_node);
@@ -711,25 +1919,28 @@ static LangNode_t *GetTernary(Language *lang_info, LangNode_t *func_name) {
 #undef DIV_
 #undef POW_
 
-static LangNode_t *ParseFunctionArgsRecursive(Language *lang_info, size_t *cnt, LangNode_t *func_name) {
+static LangNode_t *ParseFunctionArgsRecursive(Language *lang_info, size_t *cnt, size_t func_pos) {
     assert(lang_info);
     assert(cnt);
 
-    CHECK_NULL_RETURN(token, GetStackElem(lang_info->tokens, *lang_info->tokens_pos));
+    size_t token_pos = *lang_info->tokens_pos;
+    if (token_pos >= lang_info->token_buf->size) {
+        return NULL;
+    }
 
-    if (IsThatOperation(token, kOperationParClose)) {
+    if (IS_TOKEN_OP(token_pos, kOperationParClose)) {
         (*lang_info->tokens_pos)++;
         return NULL;
     }
 
-    if (IsThatOperation(token, kOperationComma)) {
+    if (IS_TOKEN_OP(token_pos, kOperationComma)) {
         (*lang_info->tokens_pos)++;
-        return ParseFunctionArgsRecursive(lang_info, cnt, func_name);
+        return ParseFunctionArgsRecursive(lang_info, cnt, func_pos);
     }
 
-    CHECK_NULL_RETURN(expr, GetExpression(lang_info, func_name));
+    CHECK_NULL_RETURN(expr, GetExpression(lang_info, func_pos));
 
-    token = expr;
+    LangNode_t *token = expr;
     (*lang_info->tokens_pos)++;
 
     if (IsThatOperation(token, kOperationGetAddr)) {
@@ -738,7 +1949,7 @@ static LangNode_t *ParseFunctionArgsRecursive(Language *lang_info, size_t *cnt,
     }
 
     (*cnt)++;
-    LangNode_t *next_arg = ParseFunctionArgsRecursive(lang_info, cnt, func_name);
+    LangNode_t *next_arg = ParseFunctionArgsRecursive(lang_info, cnt, func_pos);
     if (next_arg) {
         return NEWOP(kOperationComma, token, next_arg);
     }
@@ -746,145 +1957,164 @@ static LangNode_t *ParseFunctionArgsRecursive(Language *lang_info, size_t *cnt,
     return token;
 }
 
-static LangNode_t *ParseFunctionArgs(Language *lang_info, size_t *cnt, LangNode_t *func_name) {
+static LangNode_t *ParseFunctionArgs(Language *lang_info, size_t *cnt, size_t func_pos) {
     assert(lang_info);
     assert(cnt);
 
-    LangNode_t *token = NULL;
+    size_t token = 0;
     size_t save_pos = (*lang_info->tokens_pos);
-    CHECK_EXPECTED_TOKEN(token, IsThatOperation(token, kOperationParOpen), ); //
+    CHECK_EXPECTED_TOKEN(token, IS_TOKEN_OP(token, kOperationParOpen), ); //
 
-    return ParseFunctionArgsRecursive(lang_info, cnt, func_name);
+    return ParseFunctionArgsRecursive(lang_info, cnt, func_pos);
 }
 
-static LangNode_t *ParseBody(Language *lang_info, LangNode_t *func_name) {
+// The statements of a body go into one block, an empty body has none.
+static LangNode_t *ParseBody(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
-    LangNode_t *body_root = NULL, *token = NULL;
+    LangNode_t *body_root = NULL;
+    size_t token = 0;
     size_t save_pos = *(lang_info->tokens_pos);
 
-    CHECK_EXPECTED_TOKEN(token, IsThatOperation(token, kOperationBraceOpen),
+    CHECK_EXPECTED_TOKEN(token, IS_TOKEN_OP(token, kOperationBraceOpen),
         fprintf(stderr, "%s", "SYNTAX_ERROR_FUNC: expected '{' after function declaration\n"));
     
     while (true) {
-        LangNode_t *stmt = GetOp(lang_info, func_name);
+        LangNode_t *stmt = GetOp(lang_info, func_pos);
         if (!stmt) {
             break;
         }
 
         if (!body_root) {
-            body_root = stmt;
-        } else if (!body_root->right && IsThatOperation(body_root, kOperationThen)) {
-            body_root->right = stmt;
-        } else {
-            body_root = NEWOP(kOperationThen, body_root, stmt);
+            body_root = NewBlock(lang_info);
+        }
+        if (!body_root || BlockAppend(body_root, stmt) != kSuccess) {
+            return NULL;
         }
     }
     
-    CHECK_EXPECTED_TOKEN(token, IsThatOperation(token, kOperationBraceClose),
+    CHECK_EXPECTED_TOKEN(token, IS_TOKEN_OP(token, kOperationBraceClose),
         fprintf(stderr, "SYNTAX_ERROR_FUNC: expected '}' at end of function body %zu.\n", *(lang_info->tokens_pos)));
 
     return body_root;
 }
 
-static LangNode_t *GetAssignmentLValue(Language *lang_info, LangNode_t *func_name) {
+static LangNode_t *GetAssignmentLValue(Language *lang_info, size_t func_pos) {
+    assert(lang_info);
+
+    RETURN_MEMOIZED(kMemoLValue, func_pos, ParseAssignmentLValue(lang_info, func_pos));
+}
+
+static LangNode_t *ParseAssignmentLValue(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
     size_t save_pos = *lang_info->tokens_pos;
+    size_t var_tok = 0;
     
-    LangNode_t *maybe_var = GetVariableAddr(lang_info, func_name, klvalue);
+    LangNode_t *maybe_var = GetVariableAddr(lang_info, func_pos, klvalue);
     if (!maybe_var) {
         *lang_info->tokens_pos = save_pos;
-        maybe_var = GetString(lang_info, func_name, klvalue);
-        if (!maybe_var) {
+        if (!MatchString(lang_info, func_pos, klvalue, &var_tok)) {
             *lang_info->tokens_pos = save_pos;
             return NULL;
         }
     }
     
-    LangNode_t *assign_op = GetStackElem(lang_info->tokens, *(lang_info->tokens_pos)); // TODO:
-    if (!IsThatOperation(assign_op, kOperationIs)) {
+    size_t assign_tok = *(lang_info->tokens_pos); // TODO:
+    if (!IS_TOKEN_OP(assign_tok, kOperationIs)) {
         (*lang_info->tokens_pos) = save_pos;
         return NULL;
     }
     (*lang_info->tokens_pos)++;
 
-    if (!lang_info->arr->var_array[maybe_var->value.pos].func_made 
-            || strcmp(lang_info->arr->var_array[maybe_var->value.pos].func_made, lang_info->arr->var_array[func_name->value.pos].variable_name) != 0) {
+    if (!maybe_var) {
+        maybe_var = NodeFromToken(lang_info, var_tok);
+        if (!maybe_var) {
+            return NULL;
+        }
+    }
+
+    // Storing through an address declares nothing, only a plain name counts as a local.
+    if (maybe_var->type == kVariable && (!lang_info->arr->var_array[maybe_var->value.pos].func_made
+            || strcmp(lang_info->arr->var_array[maybe_var->value.pos].func_made, lang_info->arr->var_array[func_pos].variable_name) != 0)) {
         if (lang_info->arr->var_array[maybe_var->value.pos].func_made) {
             free(lang_info->arr->var_array[maybe_var->value.pos].func_made);
         }
-        lang_info->arr->var_array[maybe_var->value.pos].func_made = strdup(lang_info->arr->var_array[func_name->value.pos].variable_name);
-        lang_info->arr->var_array[func_name->value.pos].variable_value ++;
+        lang_info->arr->var_array[maybe_var->value.pos].func_made = strdup(lang_info->arr->var_array[func_pos].variable_name);
+        lang_info->arr->var_array[func_pos].variable_value ++;
     }
 
+    CHECK_NULL_RETURN(assign_op, NodeFromToken(lang_info, assign_tok));
     ConnectParentAndChild(assign_op, maybe_var, kleft);
     
     return assign_op;
 }
 
-static LangNode_t *ParseAssignmentRValue(Language *lang_info, LangNode_t *func_name, LangNode_t *lvalue) {
+static LangNode_t *ParseAssignmentRValue(Language *lang_info, size_t func_pos, LangNode_t *lvalue) {
     assert(lang_info);
-    assert(func_name);
     assert(lvalue);
 
-    LangNode_t *tok  = GetStackElem(lang_info->tokens, *(lang_info->tokens_pos));
-    LangNode_t *next = GetStackElem(lang_info->tokens, *(lang_info->tokens_pos) + 1);
+    size_t tok = *(lang_info->tokens_pos);
 
-    if (tok && IsThatOperation(next, kOperationParOpen) && !IsThatOperation(tok, kOperationSQRT) && tok->type == kVariable) {
+    if (IS_TOKEN_OP(tok + 1, kOperationParOpen) && IS_TOKEN_TYPE(tok, kVariable)) {
         return GetFunctionCall(lang_info);
     } else {
-        return GetExpression(lang_info, func_name);
+        return GetExpression(lang_info, func_pos);
     }
 }
 
 
-static LangNode_t *GetArrayAssignment(Language *lang_info, LangNode_t *func_name) {
+static LangNode_t *GetArrayAssignment(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
     size_t save_pos = *lang_info->tokens_pos;
     
-    LangNode_t *declare_node = GetStackElem(lang_info->tokens, *lang_info->tokens_pos);
-    if (IsThatOperation(declare_node, kOperationArrDecl)) {
+    size_t declare_tok = *lang_info->tokens_pos;
+    bool is_declare = IS_TOKEN_OP(declare_tok, kOperationArrDecl);
+    if (is_declare) {
         (*lang_info->tokens_pos)++;
     }
 
-    TRY_PARSE_FUNC_AND_RETURN_NULL(maybe_var, GetString(lang_info, func_name, klvalue),
-        *lang_info->tokens_pos = save_pos;);
+    size_t var_tok = 0;
+    if (!MatchString(lang_info, func_pos, klvalue, &var_tok)) {
+        *lang_info->tokens_pos = save_pos;
+        return NULL;
+    }
 
-    LangNode_t *bracket_node = NULL;
-    CHECK_EXPECTED_TOKEN(bracket_node, IsThatOperation(bracket_node, kOperationBracketOpen), );
+    size_t bracket_tok = 0;
+    CHECK_EXPECTED_TOKEN(bracket_tok, IS_TOKEN_OP(bracket_tok, kOperationBracketOpen), );
 
-    TRY_PARSE_FUNC_AND_RETURN_NULL(pos_node, GetTerm(lang_info, func_name),
+    TRY_PARSE_FUNC_AND_RETURN_NULL(pos_node, ParseInfix(lang_info, func_pos, NAME_TYPES_TABLE[kOperationMul].left_power),
         fprintf(stderr, "SYNTAX_ERROR_ARRAY: no position or size of array.\n"););
 
-    CHECK_EXPECTED_TOKEN(bracket_node, IsThatOperation(bracket_node, kOperationBracketClose), 
+    CHECK_EXPECTED_TOKEN(bracket_tok, IS_TOKEN_OP(bracket_tok, kOperationBracketClose), 
         fprintf(stderr, "SYNTAX_ERROR_ARRAY: no closing bracket.\n"););
 
-    LangNode_t *is_node = NULL;
-    CHECK_EXPECTED_TOKEN(is_node, IsThatOperation(is_node, kOperationIs), 
+    size_t is_tok = 0;
+    CHECK_EXPECTED_TOKEN(is_tok, IS_TOKEN_OP(is_tok, kOperationIs), 
         fprintf(stderr, "SYNTAX_ERROR_ARRAY: no assignment while dealing with array.\n"));
 
-    TRY_PARSE_FUNC_AND_RETURN_NULL(rvalue_node, GetExpression(lang_info, func_name),
+    TRY_PARSE_FUNC_AND_RETURN_NULL(rvalue_node, GetExpression(lang_info, func_pos),
         fprintf(stderr, "SYNTAX_ERROR_ARRAY: no assignment after '='.\n"););
     
+    size_t var_pos = TOKEN_VAR_POS(var_tok);
+    CHECK_NULL_RETURN(maybe_var, NodeFromToken(lang_info, var_tok));
+    CHECK_NULL_RETURN(is_node,   NodeFromToken(lang_info, is_tok));
     is_node->left = NEWOP(kOperationArrPos, maybe_var, pos_node);
 
-    if (IsThatOperation(declare_node, kOperationArrDecl)) {
+    if (is_declare) {
+        CHECK_NULL_RETURN(declare_node, NodeFromToken(lang_info, declare_tok));
         ConnectParentAndChild(declare_node, is_node, kleft);
-        lang_info->arr->var_array[maybe_var->value.pos].variable_value = (int)pos_node->value.number;
-        lang_info->arr->var_array[func_name->value.pos].variable_value += (int)pos_node->value.number; // TODO
+        lang_info->arr->var_array[var_pos].variable_value = (int)pos_node->value.number;
+        lang_info->arr->var_array[func_pos].variable_value += (int)pos_node->value.number; // TODO
 
         return declare_node;
     }
 
     ConnectParentAndChild(is_node, rvalue_node, kright);
 
-    if (lang_info->arr->var_array[maybe_var->value.pos].variable_value == POISON 
-        || lang_info->arr->var_array[maybe_var->value.pos].variable_value <= pos_node->value.number) {
+    if (lang_info->arr->var_array[var_pos].variable_value == POISON 
+        || lang_info->arr->var_array[var_pos].variable_value <= pos_node->value.number) {
             fprintf(stderr, "SYNTAX_ERROR_ARRAY: usage of undeclared array or index out of range.\n");
         return NULL;
     }
@@ -893,47 +2123,51 @@ static LangNode_t *GetArrayAssignment(Language *lang_info, LangNode_t *func_name
 
 }
 
-static LangNode_t *GetArrayElement(Language *lang_info, LangNode_t *func_name) {
+static LangNode_t *GetArrayElement(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
     size_t save_pos = *lang_info->tokens_pos;
-    TRY_PARSE_FUNC_AND_RETURN_NULL(maybe_var, GetString(lang_info, func_name, krvalue), *lang_info->tokens_pos = save_pos;);
+    size_t var_tok = 0;
+    if (!MatchString(lang_info, func_pos, krvalue, &var_tok)) {
+        *lang_info->tokens_pos = save_pos;
+        return NULL;
+    }
 
-    LangNode_t *bracket_node = NULL;
-    CHECK_EXPECTED_TOKEN(bracket_node, IsThatOperation(bracket_node, kOperationBracketOpen), );
+    size_t bracket_tok = 0;
+    CHECK_EXPECTED_TOKEN(bracket_tok, IS_TOKEN_OP(bracket_tok, kOperationBracketOpen), );
 
     TRY_PARSE_FUNC_AND_RETURN_NULL(number, GetNumber(lang_info),
         fprintf(stderr, "SYNTAX_ERROR_ARRAY: no position or size of array.\n"););
 
-    CHECK_NULL_RETURN(err, CheckArrayPos(lang_info->arr, maybe_var, number));
+    if (!CheckArrayPos(lang_info->arr, TOKEN_VAR_POS(var_tok), number)) {
+        return NULL;
+    }
 
-    CHECK_EXPECTED_TOKEN(bracket_node, IsThatOperation(bracket_node, kOperationBracketClose), 
+    CHECK_EXPECTED_TOKEN(bracket_tok, IS_TOKEN_OP(bracket_tok, kOperationBracketClose), 
         fprintf(stderr, "SYNTAX_ERROR_ARRAY: no closing bracket.\n"););
     
+    CHECK_NULL_RETURN(maybe_var, NodeFromToken(lang_info, var_tok));
     return NEWOP(kOperationArrPos, maybe_var, number);
 }
 
 #undef NEWN
 
-static LangNode_t *CheckArrayPos(VariableArr *arr, LangNode_t *maybe_var, LangNode_t *number) {
+static bool CheckArrayPos(VariableArr *arr, size_t var_pos, LangNode_t *number) {
     assert(arr);
-    assert(maybe_var);
     assert(number);
 
-    if (arr->var_array[maybe_var->value.pos].variable_value <= number->value.number) {
+    if (arr->var_array[var_pos].variable_value <= number->value.number) {
         fprintf(stderr, "SYNTAX_ERROR_ARRAY: usage of undeclared array or index out of range.\n");
-        return NULL;
+        return false;
     }
 
-    return maybe_var;
+    return true;
 }
 
-static bool CheckAndSetFunctionArgsNumber(Language *lang_info, LangNode_t *name_token, size_t cnt) {
+static bool CheckAndSetFunctionArgsNumber(Language *lang_info, size_t var_pos, size_t cnt) {
     assert(lang_info);
-    assert(name_token);
 
-    VariableInfo *variable = &lang_info->arr->var_array[name_token->value.pos];
+    VariableInfo *variable = &lang_info->arr->var_array[var_pos];
     
     if (variable->params_number != (int)cnt) {
         if (variable->params_number == POISON) {
@@ -960,6 +2194,65 @@ static void ConnectParentAndChild(LangNode_t *parent, LangNode_t *child, ChildNo
     }
 }
 
+static LangNode_t *NodeFromToken(Language *lang_info, size_t pos) {
+    assert(lang_info);
+    assert(lang_info->token_buf);
+    assert(pos < lang_info->token_buf->size);
+
+    const TokenBuffer *tokens = lang_info->token_buf;
+    LangNode_t *node = NewNode(lang_info, (NodeTypes)tokens->type[pos], tokens->value[pos], NULL, NULL);
+    if (node && lang_info->locate) {
+        node->loc = (uint32_t)pos + 1;
+    }
+
+    return node;
+}
+
+// The node becomes the literal its operands make, as the middle-end would fold it. Division
+// by zero and results that are not finite are left for the program to run into. The
+// operands stay in the arena since the memo may still hold them.
+static LangNode_t *FoldLiterals(Language *lang_info, LangNode_t *node) {
+    assert(lang_info);
+    assert(node);
+
+    if (!lang_info->fold || node->type != kOperation) {
+        return node;
+    }
+
+    OperationTypes operation = node->value.operation;
+    bool literal_left  = node->left  && node->left->type  == kNumber;
+    bool literal_right = node->right && node->right->type == kNumber;
+
+    if (operation == kOperationSQRT) {
+        if (!literal_left || node->right) {
+            return node;
+        }
+    } else if (operation == kOperationAdd || operation == kOperationSub || operation == kOperationMul
+            || operation == kOperationDiv || operation == kOperationPow) {
+        if (!literal_left || !literal_right) {
+            return node;
+        }
+        if (operation == kOperationDiv && fabs(node->right->value.number) < eps) {
+            return node;
+        }
+    } else {
+        return node;
+    }
+
+    double number = EvaluateOperation(operation, node->left->value.number,
+                                      literal_right ? node->right->value.number : 0);
+    if (!isfinite(number)) {
+        return node;
+    }
+
+    lang_info->root->size -= literal_right ? 2 : 1;
+    node->type = kNumber;
+    node->value.number = number;
+    node->left = node->right = NULL;
+
+    return node;
+}
+
 static LangNode_t *ParseAddrToken(Language *lang_info, LangNode_t *token) {
     assert(lang_info);
     assert(token);
@@ -968,23 +2261,23 @@ static LangNode_t *ParseAddrToken(Language *lang_info, LangNode_t *token) {
         return token;
     }
 
-    LangNode_t *next_token = GetStackElem(lang_info->tokens, *(lang_info->tokens_pos));
-    if (!next_token || !IsThisNodeType(next_token, kVariable)) {
+    size_t next_tok = *(lang_info->tokens_pos);
+    if (!IS_TOKEN_TYPE(next_tok, kVariable)) {
         fprintf(stderr, "SYNTAX_ERROR_ADDR: & must be followed by variable\n");
         return NULL;
     }
 
     (*lang_info->tokens_pos)++;
+    CHECK_NULL_RETURN(next_token, NodeFromToken(lang_info, next_tok));
     token->left = next_token;
     return token;
 }
 
-static LangNode_t *ParseSimpleAssignment(Language *lang_info, LangNode_t *func_name) {
+static LangNode_t *ParseSimpleAssignment(Language *lang_info, size_t func_pos) {
     assert(lang_info);
-    assert(func_name);
 
-    CHECK_NULL_RETURN(assign_op, GetAssignmentLValue(lang_info, func_name));
-    CHECK_NULL_RETURN(value, ParseAssignmentRValue(lang_info, func_name, assign_op));
+    CHECK_NULL_RETURN(assign_op, GetAssignmentLValue(lang_info, func_pos));
+    CHECK_NULL_RETURN(value, ParseAssignmentRValue(lang_info, func_pos, assign_op));
 
     ConnectParentAndChild(assign_op, value, kright);
 
@@ -996,9 +2289,11 @@ static LangNode_t *ParseSimpleAssignment(Language *lang_info, LangNode_t *func_n
     return assign_op;
 }
 
-static bool CheckCompareSign(LangNode_t *sign) {
-    if (sign && (IsThatOperation(sign, kOperationBE) || IsThatOperation(sign, kOperationB) || IsThatOperation(sign, kOperationAE) 
-            || IsThatOperation(sign, kOperationA) || IsThatOperation(sign, kOperationE) || IsThatOperation(sign, kOperationNE))) {
+static bool CheckCompareSign(const TokenBuffer *tokens, size_t pos) {
+    assert(tokens);
+
+    if (IsTokenOperation(tokens, pos, kOperationBE) || IsTokenOperation(tokens, pos, kOperationB) || IsTokenOperation(tokens, pos, kOperationAE) 
+            || IsTokenOperation(tokens, pos, kOperationA) || IsTokenOperation(tokens, pos, kOperationE) || IsTokenOperation(tokens, pos, kOperationNE)) {
         return true;
     }
 
@@ -4,27 +4,168 @@
 #include "Common/LanguageFunctions.h"
 #include "Common/DoGraph.h"
 #include "Reverse-End/TreeToCode.h"
-#include "Common/StackFunctions.h"
 #include "Common/ReadTree.h"
 #include "Common/CommonFunctions.h"
+#include "Front-End/LexerBench.h"
+#include "Common/Locations.h"
+#include "Front-End/ParseMemo.h"
 
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static LangErrors ApplyEditArg(Language *lang_info, FrontState *state, const char *arg);
 
 int main(int argc, char *argv[]) {
-    (void)argc;
+    if (argc > 2 && strcmp(argv[1], "--compare-lexers") == 0) {
+        return CompareLexers(argv + 2, (size_t)(argc - 2), stdout) == kSuccess ? 0 : kFailure;
+    }
+
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <source> <ast> [--lexer=table|fsm] [--locations] [--memo] [--fold] [--lazy] [--stream[=chunk_size]] [--threads[=count]] [--parse-threads[=count]] [--edit=offset,removed[,file]]...\n"
+                        "       %s --compare-lexers <source>...\n", argv[0], argv[0]);
+        return kFailure;
+    }
+
     const char *filename_in = argv[1];
     const char *filename_out= argv[2];
 
-    INIT_EVERYTHING(root, Variable_Array, lang_info, tokens, dump_info);
-    CHECK_ERROR_RETURN(ReadInfix(&lang_info, &dump_info, filename_in), &tokens, lang_info.arr, NULL);
+    bool stream = false;
+    bool incremental = false;
+    size_t chunk_size = 0;
+    size_t threads = 1;
+    LexerKinds lexer = kLexerTable;
+    bool locations = false;
+    bool memoize = false;
+    bool fold = false;
+    bool lazy = false;
+    size_t parse_threads = 1;
+    for (int i = 3; i < argc; i++) {
+        if (strncmp(argv[i], "--stream", strlen("--stream")) == 0) {
+            stream = true;
+            if (argv[i][strlen("--stream")] == '=') {
+                chunk_size = strtoul(argv[i] + strlen("--stream="), NULL, 10);
+            }
+        } else if (strncmp(argv[i], "--threads", strlen("--threads")) == 0) {
+            long online = sysconf(_SC_NPROCESSORS_ONLN);
+            threads = online > 0 ? (size_t)online : 1;
+            if (argv[i][strlen("--threads")] == '=') {
+                threads = strtoul(argv[i] + strlen("--threads="), NULL, 10);
+            }
+        } else if (strncmp(argv[i], "--parse-threads", strlen("--parse-threads")) == 0) {
+            long online = sysconf(_SC_NPROCESSORS_ONLN);
+            parse_threads = online > 0 ? (size_t)online : 1;
+            if (argv[i][strlen("--parse-threads")] == '=') {
+                parse_threads = strtoul(argv[i] + strlen("--parse-threads="), NULL, 10);
+            }
+        } else if (strncmp(argv[i], "--edit=", strlen("--edit=")) == 0) {
+            incremental = true;
+        } else if (strcmp(argv[i], "--lexer=table") == 0) {
+            lexer = kLexerTable;
+        } else if (strcmp(argv[i], "--lexer=fsm") == 0) {
+            lexer = kLexerFsm;
+        } else if (strcmp(argv[i], "--locations") == 0) {
+            locations = true;
+        } else if (strcmp(argv[i], "--memo") == 0) {
+            memoize = true;
+        } else if (strcmp(argv[i], "--fold") == 0) {
+            fold = true;
+        } else if (strcmp(argv[i], "--lazy") == 0) {
+            lazy = true;
+        } else if (strncmp(argv[i], "--lexer", strlen("--lexer")) == 0) {
+            fprintf(stderr, "Expected --lexer=table or --lexer=fsm, got \"%s\".\n", argv[i]);
+            return kFailure;
+        }
+    }
+
+    INIT_EVERYTHING(root, Variable_Array, lang_info, dump_info);
+    lang_info.lexer = lexer;
+    if (locations && (stream || incremental)) {
+        fprintf(stderr, "--locations needs the whole source at once, ignored with --stream and --edit.\n");
+        locations = false;
+    }
+    lang_info.locate = locations;
+    lang_info.fold = fold;
+    if (lazy && (stream || incremental)) {
+        fprintf(stderr, "--lazy needs the whole source at once, ignored with --stream and --edit.\n");
+        lazy = false;
+    }
+    lang_info.lazy = lazy;
+    if (parse_threads > 1 && (stream || incremental || lazy)) {
+        fprintf(stderr, "--parse-threads needs the whole source at once, ignored with --stream, --edit and --lazy.\n");
+        parse_threads = 1;
+    }
+    lang_info.parse_threads = parse_threads;
+
+    ParseMemo memo = {};
+    if (memoize) {
+        CHECK_ERROR_RETURN(ParseMemoCtor(&memo, 0), lang_info.arr, &root);
+        lang_info.memo = &memo;
+    }
+
+    if (incremental) {
+        FrontState state = {};
+        err = ReadInfixIncremental(&lang_info, &dump_info, filename_in, &state);
+
+        // Texts in between may not parse, only the last one has to.
+        for (int i = 3; i < argc && (err == kSuccess || err == kFailure); i++) {
+            if (strncmp(argv[i], "--edit=", strlen("--edit=")) == 0) {
+                err = ApplyEditArg(&lang_info, &state, argv[i] + strlen("--edit="));
+            }
+        }
+        FrontStateDtor(&state);
+        CHECK_ERROR_RETURN(err, lang_info.arr, &root);
+    } else if (stream) {
+        CHECK_ERROR_RETURN(ReadInfixStream(&lang_info, &dump_info, filename_in, chunk_size), lang_info.arr, &root);
+    } else {
+        CHECK_ERROR_RETURN(ReadInfixParallel(&lang_info, &dump_info, filename_in, threads), lang_info.arr, &root);
+    }
 
-    FILE_OPEN_AND_CHECK(ast_file, filename_out, "w", &tokens, lang_info.arr, NULL);
-    PrintAST(root.root, ast_file, &Variable_Array, 0);
+    if (memoize) {
+        ParseMemoPrintStats(&memo, stderr);
+        ParseMemoDtor(&memo);
+    }
+
+    FILE_OPEN_AND_CHECK(ast_file, filename_out, "w", lang_info.arr, &root);
+    PrintAST(root.root, ast_file, &Variable_Array, locations ? &root.locations : NULL, 0);
     fclose(ast_file);
 
-    StackDtor(&tokens, stderr);
     DtorVariableArray(&Variable_Array);
+    TreeDtor(&root);
     return 0;
+}
+
+static LangErrors ApplyEditArg(Language *lang_info, FrontState *state, const char *arg) {
+    assert(lang_info);
+    assert(state);
+    assert(arg);
+
+    char *end = NULL;
+    SourceEdit edit = {};
+    edit.offset = strtoul(arg, &end, 10);
+    if (*end != ',') {
+        fprintf(stderr, "Expected --edit=offset,removed[,file], got \"%s\".\n", arg);
+        return kSyntaxError;
+    }
+    edit.removed = strtoul(end + 1, &end, 10);
+
+    FileInfo Info = {};
+    if (*end == ',') {
+        FILE_OPEN_AND_CHECK(file, end + 1, "r", NULL, NULL);
+        LangErrors err = DoBufRead(file, end + 1, &Info);
+        fclose(file);
+        if (err != kSuccess) {
+            return err;
+        }
+
+        edit.text     = Info.buf_ptr;
+        edit.inserted = Info.filesize;
+    }
+
+    LangErrors err = ReadInfixEdit(lang_info, state, &edit);
+    DoBufFree(&Info);
+
+    return err;
 }
\ No newline at end of file
@@ -8,6 +8,10 @@
 #include "Common/Structs.h"
 #include "Common/LanguageFunctions.h"
 #include "Common/DoGraph.h"
+#include "Common/TreeWalk.h"
+#include "Common/NodeArena.h"
+#include "Common/NodePool.h"
+#include "Common/Numbers.h"
 
 static LangNode_t *AddOptimise(LangRoot *root, LangNode_t *node, bool *has_change);
 static LangNode_t *SubOptimise(Language *lang_info, LangNode_t *node, bool *has_change);
@@ -15,7 +19,8 @@ static LangNode_t *MulOptimise(Language *lang_info, LangNode_t *node, bool *has_
 static LangNode_t *DivOptimise(Language *lang_info, LangNode_t *node, bool *has_change);
 static LangNode_t *PowOptimise(Language *lang_info, LangNode_t *node, bool *has_change);
 
-static LangNode_t *CheckNodeAndConstOptimise(LangRoot *root, LangNode_t *node, bool *has_change, VariableArr *arr);
+static void FoldConstants(LangRoot *root, LangNode_t *node, bool *has_change, VariableArr *arr);
+static LangNode_t *EraseNeutralElement(Language *lang_info, LangNode_t *node, bool *has_change);
 static LangNode_t *GetSubTree(LangRoot *root, LangNode_t *node, LangNode_t *delete_node, LangNode_t *to_main);
 
 static bool IsThisNumber(LangNode_t *node, double number);
@@ -24,6 +29,12 @@ static bool IsOperation(LangNode_t *node);
 
 static double EvaluateExpression(LangNode_t *node, VariableArr *arr);
 
+static void FoldPoolConstants(NodePool *pool, uint32_t id, bool *has_change, VariableArr *arr);
+static bool ErasePoolNeutralElement(NodePool *pool, uint32_t id, uint32_t *root);
+static bool MakePoolNumber(NodePool *pool, uint32_t id, double number);
+static bool NegatePoolNode(NodePool *pool, uint32_t id);
+static bool IsPoolNumber(const NodePool *pool, uint32_t id, double number);
+
 LangNode_t *OptimiseTree(Language *lang_info, LangNode_t *node, VariableArr *arr) {
     assert(lang_info);
     assert(node);
@@ -47,13 +58,83 @@ LangNode_t *OptimiseTree(Language *lang_info, LangNode_t *node, VariableArr *arr
     return node;
 }
 
+// Same passes as OptimiseTree. A compact pool is in preorder, so going down the ids
+// reaches every node after its children, and nodes a pass adds are left for the next one.
+LangErrors OptimisePool(NodePool *pool, uint32_t *root, VariableArr *arr) {
+    assert(pool);
+    assert(root);
+    assert(arr);
+
+    LangErrors err = NodePoolCompact(pool, root);
+    bool has_change = true;
+
+    while (has_change && err == kSuccess) {
+        has_change = false;
+
+        bool folded = false;
+        for (size_t id = pool->size - 1; id > 0; id--) {
+            FoldPoolConstants(pool, (uint32_t) id, &folded, arr);
+        }
+        if (folded) {
+            err = NodePoolCompact(pool, root);
+        }
+
+        bool erased = false;
+        for (size_t id = pool->size - 1; id > 0 && err == kSuccess; id--) {
+            erased |= ErasePoolNeutralElement(pool, (uint32_t) id, root);
+        }
+        if (erased && err == kSuccess) {
+            err = NodePoolCompact(pool, root);
+        }
+
+        has_change = folded || erased;
+    }
+
+    return err;
+}
+
 LangNode_t *ConstOptimise(LangRoot *root, LangNode_t *node, bool *has_change, VariableArr *arr) {
     assert(node);
     assert(has_change);
     assert(arr);
 
-    node->right = CheckNodeAndConstOptimise(root, node->right, has_change, arr);
-    node->left = CheckNodeAndConstOptimise(root, node->left, has_change, arr);
+    TreeWalk walk = {};
+    TreeWalkCtor(&walk, &node, kWalkRightFirst);
+
+    WalkStep step = {};
+    while (TreeWalkNext(&walk, &step)) {
+        if (step.event == kWalkLeave) {
+            FoldConstants(root, step.node, has_change, arr);
+        }
+    }
+    TreeWalkDtor(&walk);
+
+    return node;
+}
+
+LangNode_t *EraseNeutralElements(Language *lang_info, LangNode_t *node, bool *has_change) {
+    assert(lang_info);
+    assert(node);
+    assert(has_change);
+
+    TreeWalk walk = {};
+    TreeWalkCtor(&walk, &node, 0);
+
+    WalkStep step = {};
+    while (TreeWalkNext(&walk, &step)) {
+        if (step.event == kWalkLeave) {
+            *step.link = EraseNeutralElement(lang_info, step.node, has_change);
+        }
+    }
+    TreeWalkDtor(&walk);
+
+    return node;
+}
+
+static void FoldConstants(LangRoot *root, LangNode_t *node, bool *has_change, VariableArr *arr) {
+    assert(node);
+    assert(has_change);
+    assert(arr);
 
     if (IsNumber(node->left) && IsNumber(node->right)) {
         double ans = EvaluateExpression(node, arr);
@@ -66,25 +147,14 @@ LangNode_t *ConstOptimise(LangRoot *root, LangNode_t *node, bool *has_change, Va
 
         root->size -= 2;
         *has_change = true;
-        return node;
     }
-
-    return node;
 }
 
-LangNode_t *EraseNeutralElements(Language *lang_info, LangNode_t *node, bool *has_change) {
+static LangNode_t *EraseNeutralElement(Language *lang_info, LangNode_t *node, bool *has_change) {
     assert(lang_info);
     assert(node);
     assert(has_change);
 
-    if (node->left) {
-        node->left = EraseNeutralElements(lang_info, node->left, has_change);
-    }
-
-    if (node->right) {
-        node->right = EraseNeutralElements(lang_info, node->right, has_change);
-    }
-
     if ((!node->left || !node->right) || !IsOperation(node)) {
         return node;
     }
@@ -231,6 +301,131 @@ static LangNode_t *PowOptimise(Language *lang_info, LangNode_t *node, bool *has_
 #undef NEWN
 #undef MUL_
 
+static void FoldPoolConstants(NodePool *pool, uint32_t id, bool *has_change, VariableArr *arr) {
+    assert(pool);
+    assert(has_change);
+    assert(arr);
+
+    uint32_t left  = pool->left[id];
+    uint32_t right = pool->right[id];
+    if (!left || !right || pool->kind[left] != kNumber || pool->kind[right] != kNumber) {
+        return;
+    }
+
+    double ans = 0;
+    if (pool->kind[id] == kNumber) {
+        ans = pool->value[id].number;
+    } else if (pool->kind[id] == kVariable) {
+        ans = arr->var_array[pool->value[id].pos].variable_value;
+    } else {
+        ans = EvaluateOperation(pool->value[id].operation, pool->value[left].number, pool->value[right].number);
+    }
+
+    pool->kind[id] = kNumber;
+    pool->value[id].number = ans;
+    pool->left[id] = pool->right[id] = 0;
+
+    *has_change = true;
+}
+
+static bool ErasePoolNeutralElement(NodePool *pool, uint32_t id, uint32_t *root) {
+    assert(pool);
+    assert(root);
+
+    uint32_t left  = pool->left[id];
+    uint32_t right = pool->right[id];
+    if (!left || !right || pool->kind[id] != kOperation) {
+        return false;
+    }
+
+    OperationTypes operation = pool->value[id].operation;
+
+    if (operation == kOperationAdd) {
+        if (IsPoolNumber(pool, left, 0)) {
+            NodePoolReplace(pool, id, right, root);
+            return true;
+        }
+        if (IsPoolNumber(pool, right, 0)) {
+            NodePoolReplace(pool, id, left, root);
+            return true;
+        }
+    }
+    if (operation == kOperationSub) {
+        if (IsPoolNumber(pool, right, 0)) {
+            NodePoolReplace(pool, id, left, root);
+            return true;
+        }
+        if (IsPoolNumber(pool, left, 0)) {
+            return NegatePoolNode(pool, id);
+        }
+    }
+    if (operation == kOperationMul) {
+        if (IsPoolNumber(pool, left, 1)) {
+            NodePoolReplace(pool, id, right, root);
+            return true;
+        }
+        if (IsPoolNumber(pool, right, 1)) {
+            NodePoolReplace(pool, id, left, root);
+            return true;
+        }
+        if (IsPoolNumber(pool, left, 0) || IsPoolNumber(pool, right, 0)) {
+            return MakePoolNumber(pool, id, 0);
+        }
+    }
+    if (operation == kOperationDiv) {
+        if (IsPoolNumber(pool, right, 1)) {
+            NodePoolReplace(pool, id, left, root);
+            return true;
+        }
+        if (IsPoolNumber(pool, left, 0)) {
+            return MakePoolNumber(pool, id, 0);
+        }
+    }
+    if (operation == kOperationPow) {
+        if (IsPoolNumber(pool, left, 0)) {
+            return MakePoolNumber(pool, id, 0);
+        }
+        if (IsPoolNumber(pool, right, 0)) {
+            return MakePoolNumber(pool, id, 1);
+        }
+        if (IsPoolNumber(pool, right, 1)) {
+            NodePoolReplace(pool, id, left, root);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// The node stands for a new one in place, so it loses its location like NEWN nodes have none.
+static bool MakePoolNumber(NodePool *pool, uint32_t id, double number) {
+    assert(pool);
+
+    pool->kind[id] = kNumber;
+    pool->value[id].number = number;
+    pool->left[id] = pool->right[id] = 0;
+    pool->loc[id] = 0;
+
+    return true;
+}
+
+// 0 - x turns into -1 * x.
+static bool NegatePoolNode(NodePool *pool, uint32_t id) {
+    assert(pool);
+
+    uint32_t minus = NodePoolAdd(pool, kNumber, (Value){ .number = -1.0}, 0, 0);
+    if (!minus) {
+        return false;
+    }
+
+    pool->value[id].operation = kOperationMul;
+    pool->left[id] = minus;
+    pool->parent[minus] = id;
+    pool->loc[id] = 0;
+
+    return true;
+}
+
 static LangNode_t *GetSubTree(LangRoot *root, LangNode_t *node, LangNode_t *delete_node, LangNode_t *to_main) {
     assert(root);
     assert(node);
@@ -249,7 +444,7 @@ static LangNode_t *GetSubTree(LangRoot *root, LangNode_t *node, LangNode_t *dele
     }
 
     to_main = NULL;
-    free(node);
+    NodeArenaFree(&root->arena, node);
 
     return res;
 }
@@ -270,6 +465,12 @@ static bool IsNumber(LangNode_t *node) {
     return (node->type == kNumber);
 }
 
+static bool IsPoolNumber(const NodePool *pool, uint32_t id, double number) {
+    assert(pool);
+
+    return (id && pool->kind[id] == kNumber && fabs(pool->value[id].number - number) < eps);
+}
+
 static bool IsOperation(LangNode_t *node) {
     if (!node) {
         return false;
@@ -278,18 +479,6 @@ static bool IsOperation(LangNode_t *node) {
     return (node->type == kOperation);
 }
 
-static LangNode_t *CheckNodeAndConstOptimise(LangRoot *root, LangNode_t *node, 
-    bool *has_change, VariableArr *arr) {
-    assert(has_change);
-    assert(arr);
-
-    if (node && !IsNumber(node)) {
-        node = ConstOptimise(root, node, has_change, arr);
-        if (!node) return NULL;
-    }
-    return node;
-}
-
 static double EvaluateExpression(LangNode_t *node, VariableArr *arr) {
     assert(node);
     assert(arr);
@@ -301,50 +490,8 @@ static double EvaluateExpression(LangNode_t *node, VariableArr *arr) {
         return arr->var_array[node->value.pos].variable_value;
     }
 
-    #pragma clang diagnostic push
-    #pragma clang diagnostic ignored "-Wswitch-enum"
-    switch (node->value.operation) {
-    case (kOperationAdd):
-        return EvaluateExpression(node->left, arr) +
-            EvaluateExpression(node->right, arr);
-    case (kOperationSub):
-        return EvaluateExpression(node->left, arr) -
-            EvaluateExpression(node->right, arr);
-    case (kOperationMul):
-        return EvaluateExpression(node->left, arr) *
-            EvaluateExpression(node->right, arr);
-    case (kOperationDiv): {
-        double right = EvaluateExpression(node->right, arr);
-        if (fabs(right) < eps) {
-            fprintf(stderr, "Division by zero.\n");
-            return 0;
-        }
-        return EvaluateExpression(node->left, arr) / right;
-    }
-    case (kOperationPow):
-        return pow(EvaluateExpression(node->left, arr),
-                EvaluateExpression(node->right, arr));
-    case (kOperationSin):
-        return sin(EvaluateExpression(node->right, arr));
-    case (kOperationCos):
-        return cos(EvaluateExpression(node->right, arr));
-    case (kOperationTg):
-        return tan(EvaluateExpression(node->right, arr));
-    case (kOperationLn):
-        return log(EvaluateExpression(node->right, arr));
-    case (kOperationArctg):
-        return atan(EvaluateExpression(node->right, arr));
-    case (kOperationSinh):
-        return sinh(EvaluateExpression(node->right, arr));    
-    case (kOperationCosh):
-        return cosh(EvaluateExpression(node->right, arr));
-    case (kOperationTgh):
-        return tanh(EvaluateExpression(node->right, arr));
-
-    case (kOperationNone):
-    default:
-        fprintf(stderr, "Unknown operation: %d.\n", node->value.operation);
-        return 0;
-    }
-    #pragma clang diagnostic pop
+    double left  = node->left  ? EvaluateExpression(node->left, arr)  : 0;
+    double right = node->right ? EvaluateExpression(node->right, arr) : 0;
+
+    return EvaluateOperation(node->value.operation, left, right);
 }
\ No newline at end of file
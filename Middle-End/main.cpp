@@ -5,27 +5,49 @@
 #include "Middle-End/Optimise.h"
 #include "Common/ReadTree.h"
 #include "Common/CommonFunctions.h"
-#include "Common/StackFunctions.h" 
+#include "Common/NodeArena.h"
+#include "Common/NodePool.h"
 
 #include <stdlib.h>
 #include <string.h>
 
 int main(int argc, char *argv[]) {
     if (argc < 2) {
-        fprintf(stderr, "Usage: %s <tree_file>\n", argv[0]);
+        fprintf(stderr, "Usage: %s <tree_file> [--pool]\n", argv[0]);
         return 1;
     }
     char *tree_file = argv[1];
+    bool use_pool = (argc > 2 && strcmp(argv[2], "--pool") == 0);
     
-    INIT_EVERYTHING(root, Variable_Array, lang_info, tokens_no, dump_info);
+    INIT_EVERYTHING(root, Variable_Array, lang_info, dump_info);
 
     ReadTreeAndParse(&lang_info, &dump_info, tree_file);
     DoTreeInGraphviz(root.root, &dump_info, &Variable_Array);
 
-    root.root = OptimiseTree(&lang_info, root.root, &Variable_Array);
+    if (use_pool) {
+        NodePool pool = {};
+        uint32_t pool_root = 0;
+
+        CHECK_ERROR_RETURN(NodePoolCtor(&pool, root.size), &Variable_Array, &root);
+        err = NodePoolFromTree(&pool, root.root, &pool_root);
+        NodeArenaDtor(&root.arena);
+        root.root = NULL;
+        root.size = 0;
+
+        if (err == kSuccess) {
+            err = OptimisePool(&pool, &pool_root, &Variable_Array);
+        }
+        if (err == kSuccess) {
+            err = NodePoolToTree(&pool, pool_root, &root, &root.root);
+        }
+        NodePoolDtor(&pool);
+        CHECK_ERROR_RETURN(err, &Variable_Array, &root);
+    } else {
+        root.root = OptimiseTree(&lang_info, root.root, &Variable_Array);
+    }
     
-    FILE_OPEN_AND_CHECK(ast_file_write, tree_file, "w", &Variable_Array, &root, NULL);
-    PrintAST(root.root, ast_file_write, &Variable_Array, 0);
+    FILE_OPEN_AND_CHECK(ast_file_write, tree_file, "w", &Variable_Array, &root);
+    PrintAST(root.root, ast_file_write, &Variable_Array, &root.locations, 0);
     fclose(ast_file_write);
     
     DoTreeInGraphviz(root.root, &dump_info, &Variable_Array);
@@ -10,14 +10,12 @@
 #include "Front-End/Rules.h"
 #include "Common/LanguageFunctions.h"
 #include "Common/CommonFunctions.h"
-
-#define GEN_OP(op_name, func)               \
-    const char *name = "?";                 \
-    name = PrintCodeNameFromTable(op_name); \
-    func(out, node, arr, name);                                   
+#include "Common/Numbers.h"
+#include "Common/TreeWalk.h"
 
 static void GenExpr(LangNode_t *node, FILE *out, VariableArr *arr);
 static void GenThenChain(LangNode_t *node, FILE *out, VariableArr *arr, int indent);
+static void GenBlock(LangNode_t *node, FILE *out, VariableArr *arr, int indent);
 static void GenIf(LangNode_t *node, FILE *out, VariableArr *arr, int indent);
 static void GenTernary(LangNode_t *node, FILE *out, VariableArr *arr, int indent);
 static void GenWhile(LangNode_t *node, FILE *out, VariableArr *arr, int indent);
@@ -32,11 +30,13 @@ static void GenHlt(FILE *out, LangNode_t *node, VariableArr *arr, int indent);
 static void GenDraw(FILE *out, LangNode_t *node, VariableArr *arr, int indent);
 static void GenArrDecl(FILE *out, LangNode_t *node, VariableArr *arr, int indent);
 
-static void GenUnaryOperation(FILE *out, LangNode_t *node, VariableArr *arr, const char *name);
-static void GenBinaryOperation(FILE *out, LangNode_t *node, VariableArr *arr, const char *name);
-static void GenExprWithPrecedence(LangNode_t *node, OperationTypes parent_op, FILE *out, VariableArr *arr);
-static void GenCondition(FILE *out, LangNode_t *node, VariableArr *arr, const char *name);
-static void GenCall(FILE *out, LangNode_t *node, VariableArr *arr);
+static bool GenExprEnter(LangNode_t *node, FILE *out, VariableArr *arr);
+static void GenExprBetween(LangNode_t *node, FILE *out);
+static void GenExprLeave(LangNode_t *node, FILE *out);
+static bool IsParenthesised(const WalkStep *step);
+static bool IsIgnoredOperand(const WalkStep *step);
+static bool IsBinaryArithmetic(const LangNode_t *node);
+static bool IsUnaryFunction(const LangNode_t *node);
 
 #define PrintCodeNameFromTable(type) NAME_TYPES_TABLE[type].name_in_lang
 
@@ -53,6 +53,11 @@ void GenerateCodeFromAST(LangNode_t *node, FILE *out, VariableArr *arr, int inde
     assert(arr);
     if (!node) return;
 
+    if (node->type == kBlock) {
+        GenBlock(node, out, arr, indent);
+        return;
+    }
+
     if (node->type == kOperation) {
         #pragma clang diagnostic push
         #pragma clang diagnostic ignored "-Wswitch-enum"
@@ -121,93 +126,160 @@ void GenerateCodeFromAST(LangNode_t *node, FILE *out, VariableArr *arr, int inde
     fprintf(out, "%s\n", PrintCodeNameFromTable(kOperationThen));
 }
 
+// Walked rather than recursed into, a long `augeo` chain is as deep as it is long.
 static void GenExpr(LangNode_t *node, FILE *out, VariableArr *arr) { //
     if (!node) return;
     assert(out);
     assert(arr);
 
+    TreeWalk walk = {};
+    TreeWalkCtor(&walk, &node, 0);
+
+    WalkStep step = {};
+    while (TreeWalkNext(&walk, &step)) {
+        if (IsIgnoredOperand(&step)) {
+            if (step.event == kWalkEnter) {
+                TreeWalkSkip(&walk);
+            }
+            continue;
+        }
+
+        switch (step.event) {
+            case kWalkEnter:
+                if (IsParenthesised(&step)) {
+                    fprintf(out, "(");
+                }
+                if (!GenExprEnter(step.node, out, arr)) {
+                    TreeWalkSkip(&walk);
+                }
+                break;
+            case kWalkBetween:
+                GenExprBetween(step.node, out);
+                break;
+            case kWalkLeave:
+                GenExprLeave(step.node, out);
+                if (IsParenthesised(&step)) {
+                    fprintf(out, ")");
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    TreeWalkDtor(&walk);
+}
+
+// Prints what comes before the operands, false for a node printed whole.
+static bool GenExprEnter(LangNode_t *node, FILE *out, VariableArr *arr) {
+    assert(node);
+    assert(out);
+    assert(arr);
+
     switch (node->type) {
-        case kNumber:
-            fprintf(out, "%.0f", node->value.number);
-            return;
+        case kNumber: {
+            char number[NUMBER_BUF_SIZE] = "";
+            PrintNumber(number, sizeof(number), node->value.number);
+            fprintf(out, "%s", number);
+            return false;
+        }
 
         case kVariable:
             fprintf(out, "%s", arr->var_array[node->value.pos].variable_name);
-            return;
+            return false;
 
         case kOperation:
             if (IsThatOperation(node, kOperationArrPos)) {
                 fprintf(out, "%s%s%d%s", 
                     arr->var_array[node->left->value.pos].variable_name, PrintCodeNameFromTable(kOperationBracketOpen),
                     (int)node->right->value.number, PrintCodeNameFromTable(kOperationBracketClose));
-                return;
+                return false;
             }
             break;
 
+        case kBlock:
         default:
             fprintf(out, "UNKNOWN");
-            return;
+            return false;
     }
 
-    #pragma clang diagnostic push
-    #pragma clang diagnostic ignored "-Wswitch-enum"
+    if (IsUnaryFunction(node)) {
+        fprintf(out, "%s(", PrintCodeNameFromTable(node->value.operation));
+        return true;
+    }
 
-    switch (node->value.operation) {
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wswitch-enum"
 
+    switch (node->value.operation) {
         case kOperationAdd:
         case kOperationSub:
         case kOperationMul:
         case kOperationDiv:
-        case kOperationPow: {
-            GEN_OP(node->value.operation, GenBinaryOperation);
-            return;
-        }
-
+        case kOperationPow:
         case kOperationB:
         case kOperationBE:
         case kOperationA:
         case kOperationAE:
         case kOperationE:
-        case kOperationNE: {
-            GEN_OP(node->value.operation, GenCondition);
-            return;
-        }
-
+        case kOperationNE:
         case kOperationIs:
-            GenExpr(node->left, out, arr); //
-            fprintf(out, " %s ", PrintCodeNameFromTable(kOperationIs));
-            GenExpr(node->right, out, arr);
-            return;
-
         case kOperationCall:
-            GenCall(out, node, arr);
+        case kOperationComma:
+            return true;
+
+        default:
+            fprintf(out, "UNSUPPORTED_OP");
+            return false;
+    }
+
+    #pragma GCC diagnostic pop
+}
+
+static void GenExprBetween(LangNode_t *node, FILE *out) {
+    assert(node);
+    assert(out);
+
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wswitch-enum"
+
+    switch (node->value.operation) {
+        case kOperationAdd:
+        case kOperationSub:
+        case kOperationMul:
+        case kOperationDiv:
+        case kOperationPow:
+        case kOperationB:
+        case kOperationBE:
+        case kOperationA:
+        case kOperationAE:
+        case kOperationE:
+        case kOperationNE:
+        case kOperationIs:
+            fprintf(out, " %s ", PrintCodeNameFromTable(node->value.operation));
             return;
 
         case kOperationComma:
-            GenExpr(node->left, out, arr);
             fprintf(out, ", ");
-            GenExpr(node->right, out, arr);
             return;
 
-        case kOperationSin:
-        case kOperationCos:
-        case kOperationTg:
-        case kOperationLn:
-        case kOperationArctg:
-        case kOperationSinh:
-        case kOperationCosh:
-        case kOperationTgh:
-        case kOperationSQRT: {
-            GEN_OP(node->value.operation, GenUnaryOperation);
+        case kOperationCall:
+            fprintf(out, "(");
             return;
-        }
-        
+
         default:
-            fprintf(out, "UNSUPPORTED_OP");
             return;
     }
 
-    #pragma clang diagnostic pop
+    #pragma GCC diagnostic pop
+}
+
+static void GenExprLeave(LangNode_t *node, FILE *out) {
+    assert(node);
+    assert(out);
+
+    if (IsThatOperation(node, kOperationCall) || IsUnaryFunction(node)) {
+        fprintf(out, ")");
+    }
 }
 
 static void GenThenChain(LangNode_t *node, FILE *out, VariableArr *arr, int indent) {
@@ -230,6 +302,17 @@ static void GenThenChain(LangNode_t *node, FILE *out, VariableArr *arr, int inde
     }
 }
 
+static void GenBlock(LangNode_t *node, FILE *out, VariableArr *arr, int indent) {
+    assert(node);
+    assert(out);
+    assert(arr);
+
+    NodeList *list = node->value.block;
+    for (size_t i = 0; i < list->size; i++) {
+        GenerateCodeFromAST(list->items[i], out, arr, indent);
+    }
+}
+
 static void GenIf(LangNode_t *node, FILE *out, VariableArr *arr, int indent) {
     assert(node);
     assert(out);
@@ -472,70 +555,51 @@ static void GenArrDecl(FILE *out, LangNode_t *node, VariableArr *arr, int indent
         (int)node->left->right->value.number, PrintCodeNameFromTable(kOperationThen));
 }
 
-static void GenUnaryOperation(FILE *out, LangNode_t *node, VariableArr *arr, const char *name) {
-    assert(out);
-    assert(node);
-    assert(arr);
-    assert(name);
+// An operand of an arithmetic operator gets parentheses when it is an operator itself:
+// on the left only if it binds no tighter, on the right always.
+static bool IsParenthesised(const WalkStep *step) {
+    assert(step);
 
-    fprintf(out, "%s(", name);
-    GenExpr(node->left, out, arr);
-    fprintf(out, ")");
-}
-
-static void GenBinaryOperation(FILE *out, LangNode_t *node, VariableArr *arr, const char *name) {
-    assert(out);
-    assert(node);
-    assert(arr);
-    assert(name);
-
-    GenExprWithPrecedence(node->left, node->value.operation, out, arr);
-    fprintf(out, " %s ", name);
+    LangNode_t *parent = step->parent;
+    if (!parent || !IsBinaryArithmetic(parent) || step->node->type != kOperation) {
+        return false;
+    }
 
-    if (node->right && node->right->type == kOperation)  {
-        fprintf(out, "(");
-        GenExpr(node->right, out, arr);
-        fprintf(out, ")");
-    } else {
-        GenExpr(node->right, out, arr);
+    if (step->link == &parent->left) {
+        return GetOpPrecedence(step->node->value.operation) <= GetOpPrecedence(parent->value.operation);
     }
+
+    return true;
 }
 
-static void GenExprWithPrecedence(LangNode_t *node, OperationTypes parent_op, FILE *out, VariableArr *arr) {
-    assert(node);
-    assert(out);
-    assert(arr);
+// Unary functions print their left operand only.
+static bool IsIgnoredOperand(const WalkStep *step) {
+    assert(step);
 
-    if (node && node->type == kOperation && GetOpPrecedence(node->value.operation) <= GetOpPrecedence(parent_op)) {
-        fprintf(out, "(");
-        GenExpr(node, out, arr);
-        fprintf(out, ")");
-    } else {
-        GenExpr(node, out, arr);
-    }
+    return step->parent && IsUnaryFunction(step->parent) && step->link == &step->parent->right;
 }
 
-static void GenCondition(FILE *out, LangNode_t *node, VariableArr *arr, const char *name) {
-    assert(out);
+static bool IsBinaryArithmetic(const LangNode_t *node) {
     assert(node);
-    assert(arr);
-    assert(name);
 
-    GenExpr(node->left, out, arr);
-    fprintf(out, " %s ", name);
-    GenExpr(node->right, out, arr);
+    if (node->type != kOperation) {
+        return false;
+    }
+
+    OperationTypes op = node->value.operation;
+    return op == kOperationAdd || op == kOperationSub || op == kOperationMul
+        || op == kOperationDiv || op == kOperationPow;
 }
 
-static void GenCall(FILE *out, LangNode_t *node, VariableArr *arr) {
-    assert(out);
+static bool IsUnaryFunction(const LangNode_t *node) {
     assert(node);
-    assert(arr);
-
-    GenExpr(node->left, out, arr);
-    fprintf(out, "(");
 
-    if (node->right) {
-        GenExpr(node->right, out, arr);
+    if (node->type != kOperation) {
+        return false;
     }
-    fprintf(out, ")");
+
+    OperationTypes op = node->value.operation;
+    return op == kOperationSin || op == kOperationCos || op == kOperationTg || op == kOperationLn
+        || op == kOperationArctg || op == kOperationSinh || op == kOperationCosh
+        || op == kOperationTgh || op == kOperationSQRT;
 }
\ No newline at end of file
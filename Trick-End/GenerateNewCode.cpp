@@ -13,6 +13,7 @@
 #include "Front-End/Rules.h"
 #include "Common/LanguageFunctions.h"
 #include "Common/CommonFunctions.h"
+#include "Common/Numbers.h"
 #include "Reverse-End/TreeToCode.h"
 
 #define PrintCodeNameFromTable(type) NAME_TYPES_TABLE[type].name_in_lang
@@ -24,6 +25,7 @@ typedef struct {
 
 static void GenExpr(LangNode_t *node, FILE *out, VariableArr *arr);
 static void GenThenChain(LangNode_t *node, FILE *out, VariableArr *arr, int indent);
+static void GenBlock(LangNode_t *node, FILE *out, VariableArr *arr, int indent);
 static void GenIf(LangNode_t *node, FILE *out, VariableArr *arr, int indent);
 static void GenTernary(LangNode_t *node, FILE *out, VariableArr *arr, int indent);
 static void GenWhile(LangNode_t *node, FILE *out, VariableArr *arr, int indent);
@@ -55,6 +57,11 @@ void GenerateNewCodeFromAST(LangNode_t *node, FILE *out, VariableArr *arr, int i
 
     if (!node) return;
 
+    if (node->type == kBlock) {
+        GenBlock(node, out, arr, indent);
+        return;
+    }
+
     if (node->type == kOperation) {
         #pragma clang diagnostic push
         #pragma clang diagnostic ignored "-Wswitch-enum"
@@ -181,6 +188,17 @@ static void GenThenChain(LangNode_t *node, FILE *out, VariableArr *arr, int inde
     }
 }
 
+static void GenBlock(LangNode_t *node, FILE *out, VariableArr *arr, int indent) {
+    assert(node);
+    assert(out);
+    assert(arr);
+
+    NodeList *list = node->value.block;
+    for (size_t i = 0; i < list->size; i++) {
+        GenerateNewCodeFromAST(list->items[i], out, arr, indent);
+    }
+}
+
 static void GenIf(LangNode_t *node, FILE *out, VariableArr *arr, int indent) {
     assert(node);
     assert(out);
@@ -248,9 +266,12 @@ static void GenExpr(LangNode_t *node, FILE *out, VariableArr *arr) {
     if (!node) return;
 
     switch (node->type) {
-        case kNumber:
-            fprintf(out, "%.0f", node->value.number);
+        case kNumber: {
+            char number[NUMBER_BUF_SIZE] = "";
+            PrintNumber(number, sizeof(number), node->value.number);
+            fprintf(out, "%s", number);
             return;
+        }
 
         case kVariable:
             fprintf(out, "%s", GetRenamedVar(node->value.pos));
@@ -264,6 +285,7 @@ static void GenExpr(LangNode_t *node, FILE *out, VariableArr *arr) {
             }
             break;
 
+        case kBlock:
         default:
             fprintf(out, "UNKNOWN");
             return;
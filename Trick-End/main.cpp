@@ -7,7 +7,6 @@
 #include "Common/LanguageFunctions.h"
 #include "Common/DoGraph.h"
 #include "Trick-End/GenerateNewCode.h"
-#include "Common/StackFunctions.h"
 #include "Common/ReadTree.h"
 #include "Common/CommonFunctions.h"
 
@@ -16,11 +15,11 @@ int main(int argc, char *argv[]) {
     const char *filename_in = argv[1];
     const char *filename_out= argv[2];
 
-    INIT_EVERYTHING(root, Variable_Array, lang_info, token, dump_info);
+    INIT_EVERYTHING(root, Variable_Array, lang_info, dump_info);
     
-    CHECK_ERROR_RETURN(ReadInfix(&lang_info, &dump_info, filename_in), lang_info.arr, lang_info.root, NULL);
+    CHECK_ERROR_RETURN(ReadInfix(&lang_info, &dump_info, filename_in), lang_info.arr, lang_info.root);
 
-    FILE_OPEN_AND_CHECK(out_file, filename_out, "w", lang_info.arr, lang_info.root, NULL);
+    FILE_OPEN_AND_CHECK(out_file, filename_out, "w", lang_info.arr, lang_info.root);
 
     dump_info.tree = &root;
     DoTreeInGraphviz(root.root, &dump_info, &Variable_Array);
@@ -29,7 +28,7 @@ int main(int argc, char *argv[]) {
     fclose(out_file);
     
     DtorVariableArray(&Variable_Array);
-    StackDtor(&token, stderr);
+    TreeDtor(&root);
 
     return 0;
 }
\ No newline at end of file
@@ -5,6 +5,6 @@
 #include "Common/Structs.h"
 
 // LangErrors ReadTreeAndParse(Language *lang_info, DumpInfo *dump_info, const char *filename_in);
-LangErrors PrintAsm(Language *lang_info, const char *filename_out);
+LangErrors PrintAsm(Language *lang_info, const NodePool *pool, const char *filename_out, const char *filename_map);
 
 #endif //BACK_FUNCTIONS_H_
\ No newline at end of file
@@ -5,5 +5,6 @@
 #include "Common/Structs.h"
 
 void PrintProgram(FILE *file, LangNode_t *root, VariableArr *arr, int *ram_base, AsmInfo *asm_info);
+LangErrors PrintProgramPool(FILE *file, const NodePool *pool, VariableArr *arr, int *ram_base, AsmInfo *asm_info);
 
 #endif //TREE_TO_ASM_H_
\ No newline at end of file
@@ -9,40 +9,35 @@
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Warray-bounds"
 
-void CleanupOnFileError(void *arg1, void *arg2, void *arg3);
-#define INIT_EVERYTHING(root, Variable_Array, lang_info, token, dump_info)                    \
+void CleanupOnFileError(VariableArr *arr, LangRoot *root);
+#define INIT_EVERYTHING(root, Variable_Array, lang_info, dump_info)                           \
     LangErrors err = kSuccess;                                                                \
                                                                                               \
     LangRoot root = {};                                                                       \
     VariableArr Variable_Array = {};                                                          \
-    CHECK_ERROR_RETURN(LangRootCtor(&root), NULL, &Variable_Array, &root);                    \
-    CHECK_ERROR_RETURN(InitArrOfVariable(&Variable_Array, 16), NULL, &Variable_Array, &root); \
+    CHECK_ERROR_RETURN(LangRootCtor(&root), &Variable_Array, &root);                          \
+    CHECK_ERROR_RETURN(InitArrOfVariable(&Variable_Array, 16), &Variable_Array, &root);       \
                                                                                               \
-    Language lang_info = {&root, NULL, NULL, &Variable_Array};                                \
-    Stack_Info token = {};                                                                    \
-    if (strcmp(#token, "tokens_no") != 1) {                                                   \
-        CHECK_ERROR_RETURN(StackCtor(&token, 1, stderr),  NULL, &Variable_Array, &root);      \
-        lang_info.tokens = &token;                                                            \
-    }                                                                                         \
+    Language lang_info = {&root, NULL, &Variable_Array};                                      \
                                                                                               \
     INIT_DUMP_INFO(dump_info);                                                                \
     dump_info.tree = &root;
 
-#define CHECK_ERROR_RETURN(cond, arg1, arg2, arg3)                                            \
+#define CHECK_ERROR_RETURN(cond, arr, root)                                                   \
     do {                                                                                      \
         err = (cond);                                                                         \
         if (err != kSuccess) {                                                                \
-            CleanupOnFileError(arg1, arg2, arg3);                                             \
+            CleanupOnFileError(arr, root);                                                    \
             return err;                                                                       \
         }                                                                                     \
     } while (0)
 #pragma GCC diagnostic pop
 
-#define FILE_OPEN_AND_CHECK(file, filename, mode, arg1, arg2, arg3)       \
+#define FILE_OPEN_AND_CHECK(file, filename, mode, arr, root)              \
     FILE *file = fopen(filename, mode);                                   \
     if (!file) {                                                          \
         perror("Error opening file");                                     \
-        CleanupOnFileError(arg1, arg2, arg3);                             \
+        CleanupOnFileError(arr, root);                                    \
         return kErrorOpening;                                             \
     }
 
@@ -56,6 +51,7 @@ void CleanupOnFileError(void *arg1, void *arg2, void *arg3);
 LangErrors ReadTreeAndParse(Language *lang_info, DumpInfo *dump_info, const char *filename_in);
 bool IsThatOperation(LangNode_t *node, OperationTypes type);
 bool IsThisNodeType(LangNode_t *node, NodeTypes type);
-void DoBufRead(FILE *file, const char *filename, FileInfo *Info);
+LangErrors DoBufRead(FILE *file, const char *filename, FileInfo *Info);
+void DoBufFree(FileInfo *Info);
 
 #endif //COMMON_FUNCTIONS_H_
\ No newline at end of file
@@ -5,6 +5,7 @@
 #define eps 1e-12 //
 
 #define MAIN "adepio_maximus"
+#define BLOCK_NAME "{}" // title of a block node in the tree file
 
 enum LangErrors {
     kSuccess,
@@ -23,6 +24,7 @@ enum NodeTypes {
     kOperation,
     kVariable,
     kNumber,
+    kBlock,
 };
 
 enum OperationTypes {
@@ -94,13 +96,6 @@ enum DiffModes {
     kExit            = 7,
 };
 
-enum Realloc_Mode {
-    kIncrease,
-    kDecrease,
-    kNoChange,
-    kIncreaseZero,
-};
-
 enum VariableModes {
     kVarVariable,
     kVarFunction,
@@ -117,4 +112,26 @@ enum ChildNode {
     kright,
 };
 
+enum LexerKinds {
+    kLexerTable,
+    kLexerFsm,
+};
+
+enum WalkEvents {
+    kWalkEnter,
+    kWalkBetween,
+    kWalkLeave,
+};
+
+enum WalkFlags {
+    kWalkNil        = 1, // also enter empty child slots
+    kWalkRightFirst = 2,
+};
+
+enum MemoRules : unsigned char {
+    kMemoExpression,
+    kMemoLValue,
+    kMemoFunctionCall,
+};
+
 #endif //ENUMS_H_
\ No newline at end of file
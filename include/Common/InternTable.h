@@ -0,0 +1,19 @@
+#ifndef INTERN_TABLE_H_
+#define INTERN_TABLE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+uint32_t InternHash(const char *name, size_t len);
+
+LangErrors InternTableCtor(InternTable *table, size_t capacity);
+LangErrors InternTableDtor(InternTable *table);
+LangErrors InternTableReserve(InternTable *table, size_t count);
+
+bool InternTableFind(const VariableArr *arr, const char *name, size_t len, uint32_t hash, size_t *pos);
+LangErrors InternTableInsert(VariableArr *arr, uint32_t hash, size_t pos);
+
+#endif //INTERN_TABLE_H_
\ No newline at end of file
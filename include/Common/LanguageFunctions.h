@@ -5,17 +5,22 @@
 #include "Common/Structs.h"
 
 LangErrors LangRootCtor(LangRoot *root);
-LangErrors NodeCtor(LangNode_t **node, Value *value);
+LangErrors NodeCtor(LangRoot *root, LangNode_t **node, Value *value);
 LangErrors DeleteNode(LangRoot *root, LangNode_t *node);
 LangErrors TreeDtor(LangRoot *tree);
 
 LangNode_t *NewNode(Language *lang_info, NodeTypes type, Value value, LangNode_t *left, LangNode_t *right);
+LangNode_t *NewBlock(Language *lang_info);
+LangErrors BlockCtor(LangRoot *root, LangNode_t *node);
+LangErrors BlockAppend(LangNode_t *block, LangNode_t *item);
     
 LangErrors InitArrOfVariable(VariableArr *arr, size_t capacity);
+LangErrors ReserveVariableArray(VariableArr *arr, size_t capacity);
 LangErrors ResizeArray(VariableArr *arr);
 LangErrors DtorVariableArray(VariableArr *arr);
-LangNode_t *NewVariable(Language *lang_info, char *variable);
+LangErrors InternVariable(VariableArr *arr, const char *name, size_t len, size_t *pos);
+LangNode_t *NewVariable(Language *lang_info, const char *name, size_t len);
 
-LangErrors PrintAST(LangNode_t *node, FILE *file, VariableArr *arr, int indent);
+LangErrors PrintAST(LangNode_t *node, FILE *file, VariableArr *arr, const LocationTable *locations, int indent);
 
 #endif //LANGUAGE_FUNCTIONS_H_
\ No newline at end of file
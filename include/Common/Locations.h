@@ -0,0 +1,14 @@
+#ifndef LOCATIONS_H_
+#define LOCATIONS_H_
+
+#include <stdio.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+LangErrors AddLocation(LocationTable *table, size_t line, size_t col, uint32_t *loc);
+bool GetLocation(const LocationTable *table, uint32_t loc, size_t *line, size_t *col);
+LangErrors LocateTokens(LocationTable *table, const TokenBuffer *tokens, const char *src);
+void LocationTableDtor(LocationTable *table);
+
+#endif //LOCATIONS_H_
\ No newline at end of file
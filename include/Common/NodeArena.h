@@ -0,0 +1,17 @@
+#ifndef NODE_ARENA_H_
+#define NODE_ARENA_H_
+
+#include <stdio.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+void NodeArenaCtor(NodeArena *arena);
+void NodeArenaDtor(NodeArena *arena);
+
+LangNode_t *NodeArenaAlloc(NodeArena *arena);
+void NodeArenaFree(NodeArena *arena, LangNode_t *node);
+NodeList *NodeArenaAllocList(NodeArena *arena);
+void NodeArenaAdopt(NodeArena *arena, NodeArena *from);
+
+#endif //NODE_ARENA_H_
\ No newline at end of file
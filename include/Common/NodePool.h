@@ -0,0 +1,22 @@
+#ifndef NODE_POOL_H_
+#define NODE_POOL_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+LangErrors NodePoolCtor(NodePool *pool, size_t capacity);
+void NodePoolDtor(NodePool *pool);
+
+uint32_t NodePoolAdd(NodePool *pool, NodeTypes type, Value value, uint32_t left, uint32_t right);
+uint32_t NodePoolAddBlock(NodePool *pool, size_t count);
+uint32_t *NodePoolItems(const NodePool *pool, uint32_t block, size_t *count);
+void NodePoolReplace(NodePool *pool, uint32_t node, uint32_t with, uint32_t *root);
+
+LangErrors NodePoolFromTree(NodePool *pool, LangNode_t *root, uint32_t *root_id);
+LangErrors NodePoolToTree(const NodePool *pool, uint32_t id, LangRoot *tree, LangNode_t **node);
+LangErrors NodePoolCompact(NodePool *pool, uint32_t *root);
+
+#endif //NODE_POOL_H_
\ No newline at end of file
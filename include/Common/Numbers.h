@@ -0,0 +1,16 @@
+#ifndef NUMBERS_H_
+#define NUMBERS_H_
+
+#include <stdio.h>
+
+#include "Common/Enums.h"
+
+#define NUMBER_BUF_SIZE 32
+
+const char *ScanNumber(const char *string, double *number);
+bool ParseNumber(const char *begin, const char *end, double *number);
+size_t PrintNumber(char *buf, size_t size, double number);
+
+double EvaluateOperation(OperationTypes operation, double left, double right);
+
+#endif //NUMBERS_H_
\ No newline at end of file
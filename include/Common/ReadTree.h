@@ -4,6 +4,6 @@
 #include "Common/Enums.h"
 #include "Common/Structs.h"
 
-LangErrors ParseNodeFromString(const char *buffer, size_t *pos, LangNode_t *parent, LangNode_t **node_to_add, VariableArr *arr);
+LangErrors ParseNodeFromString(const char *buffer, size_t *pos, LangNode_t *parent, LangNode_t **node_to_add, VariableArr *arr, LangRoot *tree);
 
 #endif //READ_TREE_H_
\ No newline at end of file
@@ -1,16 +0,0 @@
-#ifndef STACK_FUNCTIONS_H_
-#define STACK_FUNCTIONS_H_
-
-#include <stdio.h>
-
-#include "Common/Enums.h"
-#include "Common/Structs.h"
-
-LangErrors StackCtor(Stack_Info *stk, ssize_t capacity, FILE *open_log_file);
-LangErrors StackPush(Stack_Info *stk, LangNode_t *value, FILE *open_log_file);
-LangErrors StackPop(Stack_Info *stk, LangNode_t **value, FILE *open_log_file);
-LangErrors StackRealloc(Stack_Info *stk, FILE *open_log_file, Realloc_Mode realloc_type);
-LangErrors StackDtor(Stack_Info *stk, FILE *open_log_file);
-LangNode_t *GetStackElem(Stack_Info *stk, size_t pos);
-
-#endif //STACK_FUNCTIONS_H_
\ No newline at end of file
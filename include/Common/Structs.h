@@ -2,6 +2,7 @@
 #define STRUCTS_H_
 
 #include <stdio.h>
+#include <stdint.h>
 
 #include "Common/Enums.h"
 
@@ -20,29 +21,82 @@ struct VariableInfo {
     char *func_made;
 };
 
+struct NodeList;
+
 union Value {
     OperationTypes operation;
     double number;
+    NodeList *block;
 
     size_t pos; //
 };
 
 struct FileInfo {
-    char *buf_ptr;
+    char *buf_ptr; // read-only when map_size != 0
     size_t filesize;
+    size_t map_size;
 };
 
 struct LangNode_t {
     NodeTypes type;
+    uint32_t loc; // 1 + its entry in the tree's LocationTable, 0 when unknown
     union Value value;
     LangNode_t *parent;
     LangNode_t *left;
     LangNode_t *right;
 };
 
+struct NodeList {
+    LangNode_t **items;
+    size_t size;
+    size_t capacity;
+    NodeList *next; // lists of one arena are chained for its teardown
+};
+
+struct NodeChunk {
+    NodeChunk *next;
+    LangNode_t *nodes; // right behind the header, in the same allocation
+    size_t used;
+    size_t capacity;
+};
+
+struct NodeArena {
+    NodeChunk *chunks;     // newest first
+    LangNode_t *free_list; // nodes given back, chained through `right`
+    NodeList *lists;
+};
+
+struct LocationTable {
+    uint32_t *line;
+    uint32_t *col;
+    size_t size;
+    size_t capacity;
+};
+
 struct LangRoot {
     LangNode_t *root;
     size_t size;
+    LocationTable locations;
+    NodeArena arena; // owns every node of the tree
+};
+
+struct NodePool {
+    unsigned char *kind; // NodeTypes
+    Value *value;        // a block keeps where its run starts in `items`
+    uint32_t *left;
+    uint32_t *right;
+    uint32_t *parent;
+    uint32_t *loc;
+    size_t size;         // id 0 stands for no node
+    size_t capacity;
+    uint32_t *items;     // runs of block children, each one led by its length
+    size_t items_size;
+    size_t items_capacity;
+};
+
+struct PoolFrame {
+    uint32_t id;
+    LangNode_t *node; // made for the id, its children are not yet
 };
 
 typedef struct DumpInfo {
@@ -66,10 +120,22 @@ typedef struct {
     OperationTypes type;
 } OpEntry;
 
+struct InternSlot {
+    uint32_t hash;
+    uint32_t index; // position in var_array + 1, 0 marks an empty slot
+};
+
+struct InternTable {
+    InternSlot *slots;
+    size_t size;
+    size_t capacity;
+};
+
 struct VariableArr {
     VariableInfo *var_array;
     size_t size;
     size_t capacity;
+    InternTable names;
 };
 
 struct GraphOperation {
@@ -77,94 +143,179 @@ struct GraphOperation {
     const char *color;
 };
 
-struct Stack_Info {
-    LangNode_t **data;
-    ssize_t size;
-    ssize_t capacity;
-    size_t la_size;
+struct TokenBuffer {
+    unsigned char *type;
+    Value *value;
+    uint32_t *offset;
+    size_t size;
+    size_t capacity;
+};
+
+struct WalkFrame {
+    LangNode_t **link; // the slot the node hangs from
+    LangNode_t *parent;
+    size_t depth;
+    size_t index; // children of a block visited so far
+    unsigned char stage;
+};
+
+struct TreeWalk {
+    WalkFrame *frames;
+    size_t size;
+    size_t capacity;
+    unsigned flags;
+    LangErrors error;
+};
+
+struct WalkStep {
+    WalkEvents event;
+    LangNode_t *node;
+    LangNode_t **link;
+    LangNode_t *parent;
+    size_t depth;
+};
+
+struct MemoEntry {
+    LangNode_t *node; // NULL records a failed parse
+    uint32_t pos;
+    uint32_t end;
+    uint32_t func_pos;
+    uint32_t generation; // 0 marks an empty slot
+    MemoRules rule;
+};
+
+struct ParseMemo {
+    MemoEntry *entries;
+    size_t size;
+    size_t capacity;
+    uint32_t generation;
+
+    size_t lookups;
+    size_t hits;
+    size_t tokens_saved;
 };
 
 struct Language {
     LangRoot *root;
-    Stack_Info *tokens;
     size_t *tokens_pos;
     VariableArr *arr;
+    TokenBuffer *token_buf;
+    LexerKinds lexer;
+    bool locate; // give nodes made from tokens a source location
+    bool fold;   // turn arithmetic over literals into literals while parsing
+    bool lazy;   // parse only the functions MAIN can reach
+    size_t parse_threads; // above 1 functions are parsed on this many threads
+    ParseMemo *memo;
+};
+
+struct SourceEdit {
+    size_t offset;
+    size_t removed;
+    const char *text;
+    size_t inserted;
+};
+
+struct FrontFunction {
+    size_t offset; // of its `incantatio`
+    size_t token;
+    LangNode_t *node;
+};
+
+struct FrontState {
+    char *source;
+    size_t size;
+    TokenBuffer tokens;
+    FrontFunction *funcs;
+    LangNode_t *program; // block of the funcs[i].node
+    size_t funcs_cnt;
+    size_t capacity;
+    bool dirty;         // the last parse stopped early, the next edit parses everything
 };
 
 struct LangTable {
     const char *name_in_lang;
     const char *name_in_tree;
     OperationTypes type;
+    unsigned char left_power;  // binding powers of infix operators, 0 for everything else
+    unsigned char right_power; // right below left makes the operator right-associative
+};
+
+static constexpr LangTable NAME_TYPES_TABLE [] = {
+    {"augeo",        "+",               kOperationAdd,            1, 2},
+    {"minuo",        "-",               kOperationSub,            1, 2},
+    {"multiplico",   "*",               kOperationMul,            3, 4},
+    {"divido",       "/",               kOperationDiv,            3, 4},
+    {"^",            "^",               kOperationPow,            6, 5},
+    {"sin",          "sin",             kOperationSin,            0, 0},
+    {"cos",          "cos",             kOperationCos,            0, 0},
+    {"tg",           "tg",              kOperationTg,             0, 0},
+    {"ln",           "ln",              kOperationLn,             0, 0},
+    {"arctg",        "arctg",           kOperationArctg,          0, 0},
+    {"sh",           "sh",              kOperationSinh,           0, 0},
+    {"ch",           "ch",              kOperationCosh,           0, 0},
+    {"th",           "th",              kOperationTgh,            0, 0},
+
+    {"magica",       "=",               kOperationIs,             0, 0},
+    {"si",           "if",              kOperationIf,             0, 0},
+    {"altius",       "else",            kOperationElse,           0, 0},
+    {"perpetuum",    "while",           kOperationWhile,          0, 0},
+    {"~~",           ";",               kOperationThen,           0, 0},
+    {",",            ",",               kOperationComma,          0, 0},
+    {"incantatio",   "func",            kOperationFunction,       0, 0},
+    {"call",         "call",            kOperationCall,           0, 0},
+    {"reporto",      "return",          kOperationReturn,         0, 0},
+
+    {"inferior_aut", "<=",              kOperationBE,             0, 0},
+    {"inferior",     "<",               kOperationB,              0, 0},
+    {"superior_aut", ">=",              kOperationAE,             0, 0},
+    {"superior",     ">",               kOperationA,              0, 0},
+    {"non_aequalis", "!=",              kOperationNE,             0, 0},
+    {"aequalis",     "==",              kOperationE,              0, 0},
+
+    {"sqrt",         "sqrt",            kOperationSQRT,           0, 0},
+
+    {"revelatio",    "print",           kOperationWrite,          0, 0},
+    {"printc",       "printc",          kOperationWriteChar,      0, 0},
+    {"augurio",      "scanf",           kOperationRead,           0, 0},
+
+    {"(",            "(",               kOperationParOpen,        0, 0},
+    {")",            ")",               kOperationParClose,       0, 0},
+    {"|>",           "{",               kOperationBraceOpen,      0, 0},
+    {"<|",           "}",               kOperationBraceClose,     0, 0},
+    {"exit",         "exit",            kOperationHLT,            0, 0},
+
+    {"?",            "?",               kOperationTrueSeparator,  0, 0},
+    {":",            ":",               kOperationFalseSeparator, 0, 0},
+    {"ternary",      "ternary",         kOperationTernary,        0, 0},
+
+    {"[",            "[",               kOperationBracketOpen,    0, 0},
+    {"]",            "]",               kOperationBracketClose,   0, 0},
+
+    {"pos",          "arr pos",         kOperationArrPos,         0, 0},
+    {"voco",         "declare array",   kOperationArrDecl,        0, 0},
+
+    {"&",           "&",                kOperationCallAddr,       0, 0},
+    {"$",           "$",                kOperationGetAddr,        0, 0},
+
+    {"draw",        "draw",             kOperationDraw,           0, 0},
+
+    {"NULL",         "NULL",            kOperationNone,           0, 0},
 };
+static constexpr size_t OP_TABLE_SIZE = sizeof(NAME_TYPES_TABLE) / sizeof(NAME_TYPES_TABLE[0]);
 
-static const LangTable NAME_TYPES_TABLE [] = {
-    {"augeo",        "+",               kOperationAdd},
-    {"minuo",        "-",               kOperationSub},
-    {"multiplico",   "*",               kOperationMul},
-    {"divido",       "/",               kOperationDiv},
-    {"^",            "^",               kOperationPow},
-    {"sin",          "sin",             kOperationSin},
-    {"cos",          "cos",             kOperationCos},
-    {"tg",           "tg",              kOperationTg},
-    {"ln",           "ln",              kOperationLn},
-    {"arctg",        "arctg",           kOperationArctg},
-    {"sh",           "sh",              kOperationSinh},
-    {"ch",           "ch",              kOperationCosh},
-    {"th",           "th",              kOperationTgh},
-
-    {"magica",       "=",               kOperationIs},
-    {"si",           "if",              kOperationIf},
-    {"altius",       "else",            kOperationElse},
-    {"perpetuum",    "while",           kOperationWhile},
-    {"~~",           ";",               kOperationThen},
-    {",",            ",",               kOperationComma},
-    {"incantatio",   "func",            kOperationFunction},
-    {"call",         "call",            kOperationCall},
-    {"reporto",      "return",          kOperationReturn},
-
-    {"inferior_aut", "<=",              kOperationBE},
-    {"inferior",     "<",               kOperationB},
-    {"superior_aut", ">=",              kOperationAE},
-    {"superior",     ">",               kOperationA},
-    {"non_aequalis", "!=",              kOperationNE},
-    {"aequalis",     "==",              kOperationE},
-
-    {"sqrt",         "sqrt",            kOperationSQRT},
-
-    {"revelatio",    "print",           kOperationWrite},
-    {"printc",       "printc",          kOperationWriteChar},
-    {"augurio",      "scanf",           kOperationRead},
-
-    {"(",            "(",               kOperationParOpen},
-    {")",            ")",               kOperationParClose},
-    {"|>",           "{",               kOperationBraceOpen},
-    {"<|",           "}",               kOperationBraceClose},
-    {"exit",         "exit",            kOperationHLT},
-
-    {"?",            "?",               kOperationTrueSeparator},
-    {":",            ":",               kOperationFalseSeparator},
-    {"ternary",      "ternary",         kOperationTernary},
-
-    {"[",            "[",               kOperationBracketOpen},
-    {"]",            "]",               kOperationBracketClose},
-
-    {"pos",          "arr pos",         kOperationArrPos},
-    {"voco",         "declare array",   kOperationArrDecl},
-
-    {"&",           "&",                kOperationCallAddr},
-    {"$",           "$",                kOperationGetAddr},
-
-    {"draw",        "draw",             kOperationDraw},
-
-    {"NULL",         "NULL",            kOperationNone},
-};
-static const size_t OP_TABLE_SIZE = sizeof(NAME_TYPES_TABLE) / sizeof(NAME_TYPES_TABLE[0]);
+struct SourceMap {
+    long *asm_offset;
+    uint32_t *loc;
+    size_t size;
+    size_t capacity;
+};
 
 typedef struct {
     int label_counter;
     int counter;
     int label_if;
     int label_else;
+    SourceMap *map;
 } AsmInfo;
 
 #endif //STRUCTS_H_
\ No newline at end of file
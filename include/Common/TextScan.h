@@ -0,0 +1,10 @@
+#ifndef TEXT_SCAN_H_
+#define TEXT_SCAN_H_
+
+#include <stdio.h>
+
+const char *SkipBlanks(const char *ptr, const char *end, size_t *newlines, const char **line_start);
+const char *SkipToLineEnd(const char *ptr, const char *end);
+const char *SkipBlockComment(const char *ptr, const char *end, size_t *newlines, const char **line_start);
+
+#endif //TEXT_SCAN_H_
\ No newline at end of file
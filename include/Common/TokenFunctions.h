@@ -0,0 +1,19 @@
+#ifndef TOKEN_FUNCTIONS_H_
+#define TOKEN_FUNCTIONS_H_
+
+#include <stdio.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+LangErrors TokenBufferCtor(TokenBuffer *tokens, size_t capacity);
+LangErrors TokenBufferPush(TokenBuffer *tokens, NodeTypes type, Value value, size_t offset);
+LangErrors TokenBufferReserve(TokenBuffer *tokens, size_t capacity);
+LangErrors TokenBufferSplice(TokenBuffer *tokens, size_t from, size_t to, const TokenBuffer *insert);
+LangErrors TokenBufferDtor(TokenBuffer *tokens);
+void TokenBufferClear(TokenBuffer *tokens);
+
+bool IsTokenType(const TokenBuffer *tokens, size_t pos, NodeTypes type);
+bool IsTokenOperation(const TokenBuffer *tokens, size_t pos, OperationTypes type);
+
+#endif //TOKEN_FUNCTIONS_H_
\ No newline at end of file
@@ -0,0 +1,15 @@
+#ifndef TREE_WALK_H_
+#define TREE_WALK_H_
+
+#include <stdio.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+LangErrors TreeWalkCtor(TreeWalk *walk, LangNode_t **root, unsigned flags);
+void TreeWalkDtor(TreeWalk *walk);
+
+bool TreeWalkNext(TreeWalk *walk, WalkStep *step);
+void TreeWalkSkip(TreeWalk *walk);
+
+#endif //TREE_WALK_H_
\ No newline at end of file
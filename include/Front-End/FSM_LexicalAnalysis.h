@@ -1,9 +1,20 @@
 #ifndef LEXICAL_ANALYSIS1_H_
 #define LEXICAL_ANALYSIS1_H_
 
+#include <stdio.h>
+
 #include "Common/Enums.h"
 #include "Common/Structs.h"
 
+#define FSM_STREAM_CHUNK_SIZE (64 * 1024)
+
+struct FsmStream;
+
 size_t CheckAndReturn_fsm(Language *lang_info, const char **string);
+size_t CheckAndReturnRange_fsm(Language *lang_info, const char **string, const char *end);
+
+LangErrors FsmStreamCtor(FsmStream **stream, FILE *file, size_t chunk_size);
+void FsmStreamDtor(FsmStream *stream);
+LangErrors CheckAndReturnFunction_fsm(Language *lang_info, FsmStream *stream, size_t *cnt);
 
 #endif //LEXICAL_ANALYSIS1_H_
\ No newline at end of file
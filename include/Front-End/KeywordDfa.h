@@ -0,0 +1,228 @@
+#ifndef KEYWORD_DFA_H_
+#define KEYWORD_DFA_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <type_traits>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+// Token automaton generated at compile time from NAME_TYPES_TABLE. Keywords are spelled
+// out as a trie on top of the identifier and number states, so one maximal-munch run
+// decides between them: a word keyword only wins when the whole word matches it.
+// Bytes that appear in keywords get classes of their own, the rest share four classes.
+
+#define DFA_DEAD_STATE       0
+#define DFA_START_STATE      1
+#define DFA_IDENT_STATE      2
+#define DFA_NUMBER_STATE     3
+#define DFA_MINUS_STATE      4
+#define DFA_FIRST_TRIE_STATE 5
+
+#define DFA_OTHER_CLASS 0
+#define DFA_DIGIT_CLASS 1
+#define DFA_WORD_CLASS  2
+#define DFA_MINUS_CLASS 3
+#define DFA_FIRST_KEYWORD_CLASS 4
+
+enum DfaAccept : uint8_t {
+    kDfaReject,
+    kDfaKeyword,
+    kDfaIdentifier,
+    kDfaNumber,
+};
+
+constexpr bool IsDfaDigit(unsigned char c) {
+    return c >= '0' && c <= '9';
+}
+
+constexpr bool IsDfaWordByte(unsigned char c) {
+    return IsDfaDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+constexpr bool IsDfaKeyword(const LangTable *entry) {
+    return entry->type != kOperationNone && entry->name_in_lang && entry->name_in_lang[0];
+}
+
+constexpr size_t DfaCountTrieStates(const LangTable *table, size_t table_size) {
+    size_t states = 0;
+
+    for (size_t i = 0; i < table_size; i++) {
+        if (!IsDfaKeyword(&table[i])) {
+            continue;
+        }
+
+        const char *name = table[i].name_in_lang;
+        for (size_t len = 1; name[len - 1]; len++) {
+            bool seen = false;
+
+            for (size_t j = 0; j < i && !seen; j++) {
+                if (!IsDfaKeyword(&table[j])) {
+                    continue;
+                }
+
+                const char *other = table[j].name_in_lang;
+                size_t k = 0;
+                while (k < len && other[k] && other[k] == name[k]) {
+                    k++;
+                }
+                seen = (k == len);
+            }
+
+            if (!seen) {
+                states++;
+            }
+        }
+    }
+
+    return states;
+}
+
+constexpr size_t DfaCountKeywordBytes(const LangTable *table, size_t table_size) {
+    bool used[256] = {};
+    size_t count = 0;
+
+    for (size_t i = 0; i < table_size; i++) {
+        if (!IsDfaKeyword(&table[i])) {
+            continue;
+        }
+
+        for (const char *c = table[i].name_in_lang; *c; c++) {
+            if (!used[(unsigned char)*c]) {
+                used[(unsigned char)*c] = true;
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+static constexpr size_t KEYWORD_DFA_STATES  = DFA_FIRST_TRIE_STATE + DfaCountTrieStates(NAME_TYPES_TABLE, OP_TABLE_SIZE);
+static constexpr size_t KEYWORD_DFA_CLASSES = DFA_FIRST_KEYWORD_CLASS + DfaCountKeywordBytes(NAME_TYPES_TABLE, OP_TABLE_SIZE);
+
+static_assert(KEYWORD_DFA_STATES <= UINT16_MAX, "Too many keyword prefixes for the lexer DFA.");
+static_assert(kOperationNone <= UINT8_MAX, "Operation types must fit into one byte.");
+
+typedef std::conditional<(KEYWORD_DFA_STATES <= UINT8_MAX), uint8_t, uint16_t>::type DfaState;
+
+struct KeywordDfa {
+    uint8_t byte_class[256];
+    DfaState next[KEYWORD_DFA_STATES][KEYWORD_DFA_CLASSES];
+    uint8_t accept[KEYWORD_DFA_STATES];
+    uint8_t keyword[KEYWORD_DFA_STATES];
+};
+
+constexpr KeywordDfa BuildKeywordDfa(const LangTable *table, size_t table_size) {
+    KeywordDfa dfa = {};
+    unsigned char representative[KEYWORD_DFA_CLASSES] = {};
+    bool is_word_state[KEYWORD_DFA_STATES] = {};
+
+    size_t classes = DFA_FIRST_KEYWORD_CLASS;
+    for (size_t i = 0; i < table_size; i++) {
+        if (!IsDfaKeyword(&table[i])) {
+            continue;
+        }
+
+        for (const char *c = table[i].name_in_lang; *c; c++) {
+            unsigned char byte = (unsigned char)*c;
+            if (dfa.byte_class[byte] == DFA_OTHER_CLASS) {
+                representative[classes] = byte;
+                dfa.byte_class[byte] = (uint8_t)classes++;
+            }
+        }
+    }
+
+    for (size_t byte = 1; byte < 256; byte++) {
+        unsigned char c = (unsigned char)byte;
+        if (dfa.byte_class[c] != DFA_OTHER_CLASS) {
+            continue;
+        }
+
+        if (IsDfaDigit(c)) {
+            dfa.byte_class[c] = DFA_DIGIT_CLASS;
+        } else if (IsDfaWordByte(c)) {
+            dfa.byte_class[c] = DFA_WORD_CLASS;
+        } else if (c == '-') {
+            dfa.byte_class[c] = DFA_MINUS_CLASS;
+        }
+        if (!representative[dfa.byte_class[c]]) {
+            representative[dfa.byte_class[c]] = c;
+        }
+    }
+
+    for (size_t cls = 0; cls < KEYWORD_DFA_CLASSES; cls++) {
+        unsigned char c = representative[cls];
+        if (!c) {
+            continue;
+        }
+
+        if (IsDfaWordByte(c)) {
+            dfa.next[DFA_IDENT_STATE][cls] = DFA_IDENT_STATE;
+            dfa.next[DFA_START_STATE][cls] = IsDfaDigit(c) ? DFA_NUMBER_STATE : DFA_IDENT_STATE;
+        }
+        if (IsDfaDigit(c)) {
+            dfa.next[DFA_NUMBER_STATE][cls] = DFA_NUMBER_STATE;
+            dfa.next[DFA_MINUS_STATE][cls]  = DFA_NUMBER_STATE;
+        }
+        if (c == '-') {
+            dfa.next[DFA_START_STATE][cls] = DFA_MINUS_STATE;
+        }
+    }
+
+    dfa.accept[DFA_IDENT_STATE]  = kDfaIdentifier;
+    dfa.accept[DFA_NUMBER_STATE] = kDfaNumber;
+    is_word_state[DFA_START_STATE] = true;
+
+    size_t states = DFA_FIRST_TRIE_STATE;
+    for (size_t i = 0; i < table_size; i++) {
+        if (!IsDfaKeyword(&table[i])) {
+            continue;
+        }
+
+        size_t state = DFA_START_STATE;
+        for (const char *c = table[i].name_in_lang; *c; c++) {
+            unsigned char byte = (unsigned char)*c;
+            size_t cls = dfa.byte_class[byte];
+
+            if (dfa.next[state][cls] < DFA_FIRST_TRIE_STATE) {
+                size_t child = states++;
+                bool is_word = is_word_state[state] && IsDfaWordByte(byte);
+
+                is_word_state[child] = is_word;
+                if (is_word) {
+                    for (size_t other = 0; other < KEYWORD_DFA_CLASSES; other++) {
+                        if (representative[other] && IsDfaWordByte(representative[other])) {
+                            dfa.next[child][other] = DFA_IDENT_STATE;
+                        }
+                    }
+                    dfa.accept[child] = kDfaIdentifier;
+                }
+
+                dfa.next[state][cls] = (DfaState)child;
+            }
+
+            state = dfa.next[state][cls];
+        }
+
+        if (dfa.accept[state] != kDfaKeyword) {
+            dfa.accept[state]  = kDfaKeyword;
+            dfa.keyword[state] = (uint8_t)table[i].type;
+        }
+    }
+
+    return dfa;
+}
+
+constexpr OperationTypes KeywordDfaMatch(const KeywordDfa &dfa, const char *word) {
+    size_t state = DFA_START_STATE;
+
+    for (const char *c = word; *c && state != DFA_DEAD_STATE; c++) {
+        state = dfa.next[state][dfa.byte_class[(unsigned char)*c]];
+    }
+
+    return dfa.accept[state] == kDfaKeyword ? (OperationTypes)dfa.keyword[state] : kOperationNone;
+}
+
+#endif //KEYWORD_DFA_H_
\ No newline at end of file
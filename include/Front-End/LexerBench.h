@@ -0,0 +1,13 @@
+#ifndef LEXER_BENCH_H_
+#define LEXER_BENCH_H_
+
+#include <stdio.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+#define LEXER_BENCH_RUNS 5
+
+LangErrors CompareLexers(const char *const *files, size_t count, FILE *out);
+
+#endif //LEXER_BENCH_H_
\ No newline at end of file
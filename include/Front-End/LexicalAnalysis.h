@@ -5,5 +5,8 @@
 #include "Common/Structs.h"
 
 size_t CheckAndReturn(Language *lang_info, const char **string);
+size_t CheckAndReturnRange(Language *lang_info, const char **string, const char *end);
+
+size_t LexRange(Language *lang_info, const char **string, const char *end);
 
 #endif // LEXICAL_ANALYSIS_H_
\ No newline at end of file
@@ -0,0 +1,11 @@
+#ifndef PARALLEL_LEXER_H_
+#define PARALLEL_LEXER_H_
+
+#include <stdio.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+LangErrors LexParallel(Language *lang_info, const char *buf, size_t size, size_t threads);
+
+#endif //PARALLEL_LEXER_H_
\ No newline at end of file
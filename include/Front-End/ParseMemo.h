@@ -0,0 +1,17 @@
+#ifndef PARSE_MEMO_H_
+#define PARSE_MEMO_H_
+
+#include <stdio.h>
+
+#include "Common/Enums.h"
+#include "Common/Structs.h"
+
+LangErrors ParseMemoCtor(ParseMemo *memo, size_t capacity);
+void ParseMemoDtor(ParseMemo *memo);
+void ParseMemoForget(ParseMemo *memo);
+
+bool ParseMemoFind(ParseMemo *memo, MemoRules rule, size_t pos, size_t func_pos, LangNode_t **node, size_t *end);
+void ParseMemoStore(ParseMemo *memo, MemoRules rule, size_t pos, size_t func_pos, LangNode_t *node, size_t end);
+void ParseMemoPrintStats(const ParseMemo *memo, FILE *out);
+
+#endif //PARSE_MEMO_H_
\ No newline at end of file
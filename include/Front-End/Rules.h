@@ -10,6 +10,11 @@
 
 // void CleanupOnFileError(void *arg1, void *arg2, void *arg3);
 LangErrors ReadInfix(Language *root, DumpInfo *dump_info, const char *filename);
-void DoBufRead(FILE *file, const char *filename, FileInfo *Info);
+LangErrors ReadInfixParallel(Language *lang_info, DumpInfo *dump_info, const char *filename, size_t threads);
+LangErrors ReadInfixStream(Language *lang_info, DumpInfo *dump_info, const char *filename, size_t chunk_size);
+
+LangErrors ReadInfixIncremental(Language *lang_info, DumpInfo *dump_info, const char *filename, FrontState *state);
+LangErrors ReadInfixEdit(Language *lang_info, FrontState *state, const SourceEdit *edit);
+void FrontStateDtor(FrontState *state);
 
 #endif //RULES_H_
\ No newline at end of file
@@ -8,4 +8,6 @@ LangNode_t *OptimiseTree(Language *lang_info, LangNode_t *node, VariableArr *arr
 LangNode_t *ConstOptimise(LangRoot *root, LangNode_t *node,  bool *has_change, VariableArr *arr);
 LangNode_t *EraseNeutralElements(Language *lang_info, LangNode_t *node, bool *has_change);
 
+LangErrors OptimisePool(NodePool *pool, uint32_t *root, VariableArr *arr);
+
 #endif //OPTIMISE_H_
\ No newline at end of file
@@ -0,0 +1,69 @@
+#!/bin/sh
+# Expressions nested deeper than any call stack would allow must go through all four ends,
+# and the reversed code must read back into the same tree.
+# usage: tests/deep_nesting.sh <bin_dir>
+
+BIN=$(cd "${1:-build/bin}" && pwd)
+DEPTH=${DEPTH:-100000}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 1
+
+status=0
+
+program() {
+    awk -v n="$DEPTH" -v kind="$1" 'BEGIN {
+        printf "incantatio adepio_maximus() |>\n    x magica 1 ~~\n    y magica "
+        if (kind == "chain") {
+            for (i = 1; i < n; i++) printf "x augeo "
+            printf "x"
+        } else if (kind == "power") {
+            for (i = 1; i < n; i++) printf "x ^ "
+            printf "x"
+        } else if (kind == "parens") {
+            for (i = 1; i < n; i++) printf "x multiplico ("
+            printf "x"
+            for (i = 1; i < n; i++) printf ")"
+        }
+        printf " ~~\n    revelatio (y) ~~\n<|\n"
+    }'
+}
+
+check() {
+    name=$1
+    program "$name" > "$name.txt"
+
+    if ! "$BIN/front" "$name.txt" "$name.ast" > /dev/null 2> "$name.err"; then
+        echo "FAIL $name: front"; status=1; return
+    fi
+    cp "$name.ast" "$name.opt.ast"
+    if ! "$BIN/middle" "$name.opt.ast" > /dev/null 2>> "$name.err"; then
+        echo "FAIL $name: middle"; status=1; return
+    fi
+    if ! "$BIN/back" "$name.ast" "$name.asm" > /dev/null 2>> "$name.err"; then
+        echo "FAIL $name: back"; status=1; return
+    fi
+    if ! "$BIN/reverse" "$name.ast" "$name.rev.txt" > /dev/null 2>> "$name.err"; then
+        echo "FAIL $name: reverse"; status=1; return
+    fi
+    if ! "$BIN/front" "$name.rev.txt" "$name.rev.ast" > /dev/null 2>> "$name.err"; then
+        echo "FAIL $name: front on the reversed code"; status=1; return
+    fi
+
+    if grep -q "ERROR\|runtime error" "$name.err"; then
+        echo "FAIL $name: sanitizer report"
+        grep -m 3 "ERROR\|runtime error" "$name.err"
+        status=1
+    elif ! cmp -s "$name.ast" "$name.rev.ast"; then
+        echo "FAIL $name: reversed code reads back into another tree"
+        status=1
+    else
+        echo "ok   $name"
+    fi
+}
+
+check chain
+check power
+check parens
+
+exit $status
@@ -0,0 +1,48 @@
+#!/bin/sh
+# A literal out of the range of a double is a lexer error for both lexers, never a name.
+# usage: tests/number_overflow.sh <bin_dir>
+
+BIN=$(cd "${1:-build/bin}" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 1
+
+status=0
+
+check() {
+    name=$1
+    literal=$2
+    error=$3
+    failed=0
+    printf 'incantatio adepio_maximus() |>\n    z magica %s ~~\n<|\n' "$literal" > "$name.txt"
+
+    for lexer in table fsm; do
+        "$BIN/front" "$name.txt" "$name.$lexer.ast" --lexer=$lexer > /dev/null 2> "$name.$lexer.err"
+        if ! grep -q "Lexer error \[$error\]: number does not fit into a double." "$name.$lexer.err"; then
+            echo "FAIL $name: the $lexer lexer does not report [$error]"
+            failed=1
+        elif grep -q "\"$literal\"" "$name.$lexer.ast" 2> /dev/null; then
+            echo "FAIL $name: the $lexer lexer made a name of $literal"
+            failed=1
+        fi
+    done
+
+    if ! "$BIN/front" --compare-lexers "$name.txt" > "$name.cmp" 2>&1; then
+        echo "FAIL $name: lexers disagree"
+        grep -v "tokens\|bytes\|Lexer error" "$name.cmp" | head -5
+        failed=1
+    fi
+
+    if [ $failed -eq 0 ]; then
+        echo "ok   $name"
+    else
+        status=1
+    fi
+}
+
+check exponent   1e400     2:14
+check negative   -1e400    2:14
+check after_name x-1e400   2:15
+check digits     "$(printf '9%.0s' $(seq 400))" 2:14
+
+exit $status
@@ -0,0 +1,43 @@
+#!/bin/sh
+# Broken programs must fail the same way with and without --parse-threads.
+# usage: tests/parse_threads.sh <bin_dir>
+
+BIN=$(cd "${1:-build/bin}" && pwd)
+SRC=$(cd "$(dirname "$0")/.." && pwd)/codeDraw.txt
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 1
+
+status=0
+
+check() {
+    name=$1
+    shift
+    sed "$@" "$SRC" > "$name.txt"
+
+    "$BIN/front" "$name.txt" serial.ast   > /dev/null 2> serial.err
+    serial_rc=$?
+    "$BIN/front" "$name.txt" threads.ast --parse-threads=4 > /dev/null 2> threads.err
+    threads_rc=$?
+
+    if [ $serial_rc -ne $threads_rc ] || ! cmp -s serial.err threads.err; then
+        echo "FAIL $name: serial rc=$serial_rc, threads rc=$threads_rc"
+        diff serial.err threads.err | head -20
+        status=1
+    elif [ -f serial.ast ] && ! cmp -s serial.ast threads.ast; then
+        echo "FAIL $name: trees differ"
+        status=1
+    else
+        echo "ok   $name"
+    fi
+    rm -f serial.ast threads.ast
+}
+
+check addr_lvalue   -e '0,/radius magica/s//$ radius magica/'
+check call_lvalue   -e '0,/radius magica/s//\& radius magica/'
+check no_rvalue     -e '0,/radius magica 0/s//radius magica/'
+check no_body_end   -e '0,/^<|/s///'
+check stray_token   -e '0,/~~/s//~~ ~~ )/'
+check unknown_char  -e '0,/radius magica 0/s//radius magica 0 @/'
+
+exit $status